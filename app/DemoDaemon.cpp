@@ -0,0 +1,74 @@
+#include <demoanalyser/ParseDaemon.h>
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+
+#include <unistd.h>
+
+int main(int argc, char* argv[])
+{
+    std::string mode = argc > 2 ? argv[1] : "";
+
+    if (mode == "serve") {
+        demo_analyser::ParseDaemonOptions options;
+        options.SocketPath = argv[2];
+
+        bool valid = true;
+        for (int i = 3; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--workers" && i + 1 < argc)
+                options.Workers = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+            else if (arg == "--cache" && i + 1 < argc)
+                options.CacheEntries = std::strtoul(argv[++i], nullptr, 10);
+            else
+                valid = false;
+        }
+
+        if (valid) {
+            // served until SIGINT/SIGTERM
+            sigset_t signals;
+            sigemptyset(&signals);
+            sigaddset(&signals, SIGINT);
+            sigaddset(&signals, SIGTERM);
+            pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+            demo_analyser::ParseDaemon daemon(options);
+            if (!daemon.start()) {
+                fprintf(stderr, "Failed to listen on %s: %s\n", options.SocketPath.c_str(), daemon.error().c_str());
+                return 1;
+            }
+
+            int signal = 0;
+            sigwait(&signals, &signal);
+            daemon.stop();
+            return 0;
+        }
+    } else if (mode == "send") {
+        // the remaining arguments are the request: a verb then key=value fields
+        std::string request;
+        for (int i = 3; i < argc; ++i) {
+            if (i > 3)
+                request += '\t';
+            request += argv[i];
+        }
+
+        if (!request.empty()) {
+            try {
+                std::string response = demo_analyser::SendDaemonRequest(argv[2], request);
+                fwrite(response.data(), 1, response.size(), stdout);
+                return response.compare(0, 2, "OK") == 0 ? 0 : 1;
+            } catch (const std::exception& ex) {
+                fprintf(stderr, "%s\n", ex.what());
+                return 1;
+            }
+        }
+    }
+
+    printf("Usage: %s serve <socket> [--workers N] [--cache N]\n", argv[0]);
+    printf("       %s send <socket> PARSE path=<demo> [start=<s>] [end=<s>] [outputs=summary,ndjson,csv,arrow,trajectory] [prefix=<p>]\n", argv[0]);
+    printf("       %s send <socket> STATS\n", argv[0]);
+    return 1;
+}
@@ -1,69 +1,210 @@
+#include <demoanalyser/ArrowExporter.h>
+#include <demoanalyser/DemoFingerprint.h>
 #include <demoanalyser/DemoParser.h>
 #include <demoanalyser/EventHandlers.h>
+#include <demoanalyser/EventLog.h>
+#include <demoanalyser/SharedEventRing.h>
+#include <demoanalyser/TextExporter.h>
+#include <demoanalyser/TailFileByteSource.h>
+#include <demoanalyser/TrajectoryWriter.h>
 
 void OnReadHeader(const DemoHeader demoHeader)
 {
-    std::cout<<demoHeader.mapName<<std::endl;
+    std::cout<<demoHeader.mapName<<"\n";
 
-    std::cout<<demoHeader.demoDirectory[1].frameCount<<std::endl;
-    std::cout<<demoHeader.demoDirectory[1].trackTime<<std::endl;
+    std::cout<<demoHeader.demoDirectory[1].frameCount<<"\n";
+    std::cout<<demoHeader.demoDirectory[1].trackTime<<"\n";
 }
 
 void OnUpdateUserInfo(UpdateUserInfo &updateUserInfo)
 {
-    //std::cout<<updateUserInfo.ClientUserInfo<<std::endl;
+    //std::cout<<updateUserInfo.ClientUserInfo<<"\n";
 }
 
 void OnServerInfo(ServerInfo &serverInfo)
 {
-    std::cout<<serverInfo.Hostname<<std::endl;
+    std::cout<<serverInfo.Hostname<<"\n";
 }
 
 void OnClientData(ClientData& clientData) 
 {
-    //std::cout<<clientData.origin[0]<<" "<<clientData.origin[1]<<" "<<clientData.origin[2]<<std::endl;
+    //std::cout<<clientData.origin[0]<<" "<<clientData.origin[1]<<" "<<clientData.origin[2]<<"\n";
 }
 
 void OnPlayerState(PlayerState& playerState)
 {
-    //std::cout<<playerState.position[0]<<" "<<playerState.position[1]<<" "<<playerState.position[2]<<std::endl;
+    //std::cout<<playerState.position[0]<<" "<<playerState.position[1]<<" "<<playerState.position[2]<<"\n";
 }
 
 void OnTimeTick(float Time)
 {
-    //std::cout<<Time<<std::endl;
+    //std::cout<<Time<<"\n";
 }
 void OnMessagePrint(const std::string &message)
 {
-    //std::cout<<message<<std::endl;
+    //std::cout<<message<<"\n";
 }
 
 void OnConsoleCommand(const std::string &command)
 {
-    //std::cout<<command<<std::endl;
+    //std::cout<<command<<"\n";
 }
 
 void OnEventFrame(const EventFrame &eventFrame)
 {
-    //std::cout<<eventFrame.index<<std::endl;
+    //std::cout<<eventFrame.index<<"\n";
 }
 
 void OnNewMoveVars(MoveVars &moveVars)
 {
-    //std::cout<<moveVars.maxspeed<<std::endl;
+    //std::cout<<moveVars.maxspeed<<"\n";
 }
 int main(int argc, char* argv[]) 
 {
-    if (argc < 2) {
-        printf("Usage: %s <filename>\n", argv[0]);
+    const char* filename = nullptr;
+    bool readAhead = false;
+    bool follow = false;
+    bool cache = false;
+    bool fingerprint = false;
+    std::string exportFormat;
+    std::string outputPrefix;
+    std::string publishName;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--read-ahead")
+            readAhead = true;
+        else if (arg == "--follow")
+            follow = true;
+        else if (arg == "--cache")
+            cache = true;
+        else if (arg == "--fingerprint")
+            fingerprint = true;
+        else if (arg == "--export" && i + 1 < argc)
+            exportFormat = argv[++i];
+        else if (arg == "--output" && i + 1 < argc)
+            outputPrefix = argv[++i];
+        else if (arg == "--publish" && i + 1 < argc)
+            publishName = argv[++i];
+        else {
+            filename = argv[i];
+            files.push_back(arg);
+        }
+    }
+
+    if (fingerprint && !files.empty()) {
+        // "<content> <match> <path>" per demo, then the groups of copies of the same recording
+        auto fingerprints = demo_analyser::FingerprintDemos(files);
+        for (size_t i = 0; i < files.size(); ++i) {
+            if (fingerprints[i].Valid)
+                printf("%016llx %016llx %s\n", (unsigned long long)fingerprints[i].Content, (unsigned long long)fingerprints[i].Match, files[i].c_str());
+            else
+                fprintf(stderr, "%s: %s\n", files[i].c_str(), fingerprints[i].Error.c_str());
+        }
+
+        for (const auto& group : demo_analyser::GroupDemos(fingerprints, demo_analyser::DemoGrouping::Content)) {
+            printf("duplicates:");
+            for (size_t index : group)
+                printf(" %s", files[index].c_str());
+            printf("\n");
+        }
+        return 0;
+    }
+
+    if (!filename || (cache && follow) || (!exportFormat.empty() && exportFormat != "ndjson" && exportFormat != "csv" && exportFormat != "arrow" && exportFormat != "trajectory")) {
+        printf("Usage: %s [--read-ahead | --follow | --cache] [--export ndjson|csv|arrow|trajectory [--output <prefix>]] [--publish <shm name>] <filename>\n", argv[0]);
+        printf("       %s --fingerprint <filename>...\n", argv[0]);
         return 1;
     }
 
-    const char* filename = argv[1];
+    // one file per event type, next to the demo unless told otherwise
+    if (outputPrefix.empty()) {
+        outputPrefix = filename;
+        size_t dot = outputPrefix.find_last_of('.');
+        size_t slash = outputPrefix.find_last_of('/');
+        if (dot != std::string::npos && (slash == std::string::npos || dot > slash))
+            outputPrefix.erase(dot);
+        outputPrefix += "_";
+    }
+
+    std::unique_ptr<demo_analyser::TextExporter> textExporter;
+    std::unique_ptr<demo_analyser::ArrowExporter> arrowExporter;
+    std::unique_ptr<demo_analyser::TrajectoryWriter> trajectoryWriter;
+    demo_analyser::DemoEventSink* sink = nullptr;
+
+    if (exportFormat == "arrow") {
+        arrowExporter = std::make_unique<demo_analyser::ArrowExporter>(outputPrefix);
+        sink = arrowExporter.get();
+    } else if (exportFormat == "trajectory") {
+        trajectoryWriter = std::make_unique<demo_analyser::TrajectoryWriter>(outputPrefix + "trajectories.hltj");
+        sink = trajectoryWriter.get();
+    } else if (!exportFormat.empty()) {
+        textExporter = std::make_unique<demo_analyser::TextExporter>(outputPrefix,
+            exportFormat == "csv" ? demo_analyser::TextFormat::Csv : demo_analyser::TextFormat::NDJson);
+        sink = textExporter.get();
+    }
+
+    // shared memory ring for other local processes, alongside any export
+    std::unique_ptr<demo_analyser::SharedEventRingWriter> ring;
+    demo_analyser::FanOutEventSink fanOut;
+    if (!publishName.empty()) {
+        ring = std::make_unique<demo_analyser::SharedEventRingWriter>(publishName);
+        if (!ring->isOpen()) {
+            fprintf(stderr, "Failed to create %s: %s\n", publishName.c_str(), ring->error().c_str());
+            return 1;
+        }
 
-    // Read demo header
-    demo_analyser::DemoParser demoParser(filename);
-    demoParser.parseDemo();
+        if (sink)
+            fanOut.add(sink);
+        fanOut.add(ring.get());
+        sink = &fanOut;
+    }
+
+    if (cache) {
+        // replays <demo>.evlog when it is current, otherwise parses and writes it
+        demo_analyser::ParseWithEventLog(filename, sink);
+    } else {
+        std::unique_ptr<demo_analyser::ByteSource> source;
+        if (follow)
+            source = std::make_unique<demo_analyser::TailFileByteSource>(filename);
+        else
+            source = demo_analyser::OpenFileByteSource(filename, readAhead);
+
+        // Read demo header
+        demo_analyser::DemoParser demoParser(std::move(source));
+        if (sink)
+            demoParser.setEventSink(sink);
+
+        demoParser.parseDemo();
+    }
+
+    if (ring)
+        ring->finish();
+
+    if (textExporter) {
+        textExporter->finish();
+        if (!textExporter->good()) {
+            fprintf(stderr, "Failed to write %s*\n", outputPrefix.c_str());
+            return 1;
+        }
+    }
+
+    if (arrowExporter) {
+        arrowExporter->finish();
+        if (!arrowExporter->good()) {
+            fprintf(stderr, "Failed to write %s*\n", outputPrefix.c_str());
+            return 1;
+        }
+    }
+
+    if (trajectoryWriter) {
+        trajectoryWriter->finish();
+        if (!trajectoryWriter->good()) {
+            fprintf(stderr, "Failed to write %strajectories.hltj\n", outputPrefix.c_str());
+            return 1;
+        }
+    }
 
     //demo_analyser::PrintHeader(demo.header);
 
@@ -7,6 +7,7 @@
 #include <sstream>
 #include <cstring>
 #include <array>
+#include <DecodeError.h>
 
 enum class EndianType { Little, Big };
 
@@ -16,10 +17,16 @@ private:
 	size_t currentBit = 0;
 	EndianType endian = EndianType::Little;
 
-	void checkBounds(size_t nBits) const {
+	DecodeError error = DecodeError::None;
+	size_t errorBit = 0;
+	int32_t errorValue = 0;
+
+	bool checkBounds(size_t nBits) {
 		if (currentBit + nBits > data.size() * 8) {
-			throw std::runtime_error("BitBuffer out of range");
+			fail(DecodeError::Overflow);
+			return false;
 		}
+		return true;
 	}
 
 public:
@@ -32,20 +39,41 @@ public:
 	size_t bitsLeft() const { return data.size() * 8 - currentBit; }
 	size_t bytesLeft() const { return data.size() - (currentBit / 8); }
 	size_t currentByte() const { return currentBit / 8; }
+	size_t currentBitOffset() const { return currentBit; }
 
 	void setEndian(EndianType e) { endian = e; }
 	EndianType getEndian() const { return endian; }
 
+	// Records the first error and moves to the end, so every later read fails fast and returns zero
+	void fail(DecodeError e, int32_t value = 0) {
+		if (error == DecodeError::None) {
+			error = e;
+			errorBit = currentBit;
+			errorValue = value;
+		}
+		currentBit = data.size() * 8;
+	}
+
+	bool hasError() const { return error != DecodeError::None; }
+	DecodeError getError() const { return error; }
+	size_t getErrorBit() const { return errorBit; }
+	int32_t getErrorValue() const { return errorValue; }
+	void clearError() { error = DecodeError::None; errorBit = 0; errorValue = 0; }
+
 	void seekBits(int offset) { seekBits(offset, std::ios_base::cur); }
 
 	void seekBits(int offset, std::ios_base::seekdir origin) {
-		if (origin == std::ios_base::beg) currentBit = offset;
-		else if (origin == std::ios_base::cur) currentBit += offset;
-		else if (origin == std::ios_base::end) currentBit = data.size() * 8 - offset;
-
-		if (currentBit < 0 || currentBit > data.size() * 8) {
-			throw std::runtime_error("BitBuffer out of range");
+		int64_t target = 0;
+		if (origin == std::ios_base::beg) target = offset;
+		else if (origin == std::ios_base::cur) target = static_cast<int64_t>(currentBit) + offset;
+		else if (origin == std::ios_base::end) target = static_cast<int64_t>(data.size() * 8) - offset;
+
+		if (target < 0 || target > static_cast<int64_t>(data.size() * 8)) {
+			fail(DecodeError::Overflow);
+			return;
 		}
+
+		currentBit = static_cast<size_t>(target);
 	}
 
 	void seekBytes(int offset) { seekBits(offset * 8); }
@@ -57,7 +85,7 @@ public:
 	}
 
 	bool readBoolean() {
-		checkBounds(1);
+		if (!checkBounds(1)) return false;
 		size_t byteIndex = currentBit / 8;
 		size_t bitIndex = currentBit % 8;
 		bool value = false;
@@ -73,15 +101,28 @@ public:
 	}
 
 	uint32_t readUnsignedBits(int nBits) {
-		if (nBits <= 0 || nBits > 32) throw std::invalid_argument("nBits must be 1-32");
-		checkBounds(nBits);
+		if (nBits < 0 || nBits > 32) {
+			fail(DecodeError::InvalidBitCount, nBits);
+			return 0;
+		}
+		if (nBits == 0) return 0;
+		if (!checkBounds(nBits)) return 0;
 
 		uint32_t result = 0;
 
 		if (endian == EndianType::Little) {
-			for (int i = 0; i < nBits; ++i) {
-				if (readBoolean()) result |= (1u << i);
+			// gather the (at most 5) bytes covering the field and shift it out in one go
+			size_t byteIndex = currentBit / 8;
+			size_t bitIndex = currentBit % 8;
+			size_t nBytes = (bitIndex + nBits + 7) / 8;
+
+			uint64_t chunk = 0;
+			for (size_t i = 0; i < nBytes; ++i) {
+				chunk |= static_cast<uint64_t>(data[byteIndex + i]) << (i * 8);
 			}
+
+			result = static_cast<uint32_t>((chunk >> bitIndex) & ((uint64_t{1} << nBits) - 1));
+			currentBit += nBits;
 		} else {
 			for (int i = 0; i < nBits; ++i) {
 				if (readBoolean()) result |= (1u << (nBits - 1 - i));
@@ -92,7 +133,10 @@ public:
 	}
 
 	int32_t readBits(int nBits) {
-		if (nBits <= 0 || nBits > 32) throw std::invalid_argument("nBits must be 1-32");
+		if (nBits <= 0 || nBits > 32) {
+			fail(DecodeError::InvalidBitCount, nBits);
+			return 0;
+		}
 
 		uint32_t magnitude = readUnsignedBits(nBits - 1);
 		bool sign = readBoolean();
@@ -123,29 +167,33 @@ public:
 
 	float readFloat() {
 		uint8_t bytes[4];
-		auto b = readBytes(4);
-		std::memcpy(bytes, b.data(), 4);
+		for (int i = 0; i < 4; ++i) {
+			bytes[i] = readByte();
+		}
 		float val;
 		std::memcpy(&val, bytes, sizeof(float));
 		return val;
 	}
 
 	std::string readString() {
-		std::stringstream ss;
+		std::string s;
 		while (true) {
 			uint8_t b = readByte();
 			if (b == 0) break;
-			ss << static_cast<char>(b);
+			s.push_back(static_cast<char>(b));
 		}
-		return ss.str();
+		return s;
+	}
+
+	void skipString() {
+		while (readByte() != 0) {}
 	}
 
 	std::string readString(size_t length) {
 		size_t startBit = currentBit;
 		std::string s = readString();
 		size_t bitsRead = currentBit - startBit;
-		size_t remainingBits = length * 8 - bitsRead;
-		if (remainingBits > 0) seekBits(remainingBits);
+		if (bitsRead < length * 8) seekBits(static_cast<int>(length * 8 - bitsRead));
 		return s;
 	}
 
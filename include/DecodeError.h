@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+// First error hit while decoding a buffer. Recorded once and kept (sticky) until cleared,
+// so hot loops read on and callers check once per message.
+enum class DecodeError : uint8_t {
+	None = 0,
+	Overflow,               // read or seek past the end of the buffer
+	InvalidBitCount,        // bit count outside 0-32
+	UnknownDeltaType,       // delta entry flags name no known encoding
+	MissingDeltaStructure,  // delta structure used before its SVC_DELTADESCRIPTION
+	UnknownMessage,         // message id with no handler
+	UnknownTempEntity,      // SVC_TEMPENTITY type with no known layout
+	BadFooter,              // message terminator did not match
+};
+
+inline const char* DecodeErrorName(DecodeError error)
+{
+	switch (error)
+	{
+		case DecodeError::None:                  return "No error";
+		case DecodeError::Overflow:              return "Read past end of buffer";
+		case DecodeError::InvalidBitCount:       return "Invalid bit count";
+		case DecodeError::UnknownDeltaType:      return "Unknown delta entry type";
+		case DecodeError::MissingDeltaStructure: return "Delta structure not found";
+		case DecodeError::UnknownMessage:        return "Unknown message handler";
+		case DecodeError::UnknownTempEntity:     return "Unknown tempentity type";
+		case DecodeError::BadFooter:             return "Bad message footer";
+	}
+	return "Unknown error";
+}
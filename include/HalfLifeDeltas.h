@@ -21,6 +21,44 @@ inline float toFloat(const DeltaValue& value) {
     }, value);
 }
 
+inline int toInt(const DeltaValue& value) {
+    return std::visit([](auto&& arg) -> int {
+        using T = std::decay_t<decltype(arg)>;
+        if constexpr (std::is_arithmetic_v<T>) {
+            return static_cast<int>(arg);
+        } else {
+            throw std::runtime_error("Cannot convert non-numeric type to int");
+        }
+    }, value);
+}
+
+// FNV-1a over a delta description, usable on runtime entries and constexpr tables alike
+constexpr uint64_t DeltaFingerprintBasis = 14695981039346656037ull;
+
+constexpr uint64_t deltaFingerprintMix(uint64_t hash, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        hash ^= (value >> (i * 8)) & 0xFF;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+constexpr uint64_t deltaFingerprintMix(uint64_t hash, const char* str) {
+    for (; *str; ++str) {
+        hash ^= static_cast<uint8_t>(*str);
+        hash *= 1099511628211ull;
+    }
+    return deltaFingerprintMix(hash, 0u);
+}
+
+// divisor is hashed as it travels on the wire (scaled by 4000), not as float bits
+constexpr uint64_t deltaFingerprintEntry(uint64_t hash, const char* name, uint32_t flags, uint32_t nBits, float divisor) {
+    hash = deltaFingerprintMix(hash, name);
+    hash = deltaFingerprintMix(hash, flags);
+    hash = deltaFingerprintMix(hash, nBits);
+    return deltaFingerprintMix(hash, static_cast<uint32_t>(divisor * 4000.0f + 0.5f));
+}
+
 class HalfLifeDelta {
 private:
     struct Entry {
@@ -30,6 +68,7 @@ private:
 
     std::vector<Entry> entries;
     std::unordered_map<std::string, size_t> nameIndexMap;
+    uint64_t presentMask = 0;  // entries set by the last readDelta, by index
 
 public:
     HalfLifeDelta(size_t nEntries = 0) { entries.reserve(nEntries); }
@@ -60,6 +99,13 @@ public:
     void setEntryValue(size_t index, const DeltaValue& value) {
         if (index >= entries.size()) throw std::out_of_range("Delta entry index out of range");
         entries[index].value = value;
+        if (index < 64) presentMask |= uint64_t{1} << index;
+    }
+
+    // Whether the named entry was sent, as opposed to left at its default
+    bool isEntryPresent(const std::string& name) const {
+        auto it = nameIndexMap.find(name);
+        return it != nameIndexMap.end() && it->second < 64 && (presentMask >> it->second) & 1;
     }
 
     size_t size() const { return entries.size(); }
@@ -91,14 +137,20 @@ public:
 private:
     std::string name;
     std::vector<Entry> entryList;
+    uint64_t fingerprint = DeltaFingerprintBasis;
 
 public:
     HalfLifeDeltaStructure(const std::string& name_) : name(name_) {}
 
     const std::string& getName() const { return name; }
+    const std::vector<Entry>& getEntries() const { return entryList; }
+
+    // Hash of the entry layout, built up as entries are registered
+    uint64_t getFingerprint() const { return fingerprint; }
 
     void addEntry(const std::string& entryName, uint32_t nBits, float divisor, EntryFlags flags) {
         entryList.push_back({entryName, nBits, divisor, flags, 1.0f});
+        fingerprint = deltaFingerprintEntry(fingerprint, entryName.c_str(), static_cast<uint32_t>(flags), nBits, divisor);
     }
 
     void addEntry(const HalfLifeDelta& delta) {
@@ -151,40 +203,38 @@ public:
         readDelta(buf, nullptr);
     }
 
-    void readDelta(BitBuffer& bitBuffer, HalfLifeDelta* delta) const {
-
-        std::vector<uint8_t> bitmaskBytes;
+    // Reads the present-field mask that precedes every delta, at most 7 * 8 = 56 bits
+    static uint64_t readBitmask(BitBuffer& bitBuffer) {
         // read 3-bit unsigned value for the number of bitmask bytes
         uint32_t nBitmaskBytes = bitBuffer.readUnsignedBits(3);
 
-        if (nBitmaskBytes == 0) {
-            bitmaskBytes.clear();
-            return;
+        uint64_t bitmask = 0;
+        for (uint32_t i = 0; i < nBitmaskBytes; ++i) {
+            bitmask |= static_cast<uint64_t>(bitBuffer.readByte()) << (i * 8);
         }
+        return bitmask;
+    }
+
+    void readDelta(BitBuffer& bitBuffer, HalfLifeDelta* delta) const {
 
-        bitmaskBytes.resize(nBitmaskBytes);
+        uint64_t bitmask = readBitmask(bitBuffer);
 
-        // read the bitmask bytes
-        for (uint32_t i = 0; i < nBitmaskBytes; ++i) {
-            bitmaskBytes[i] = bitBuffer.readByte();
+        // drop bits for fields this structure does not declare
+        if (entryList.size() < 64) {
+            bitmask &= (uint64_t{1} << entryList.size()) - 1;
         }
 
-        // iterate through each bit in each byte
-        for (uint32_t i = 0; i < nBitmaskBytes; ++i) {
-            for (uint32_t j = 0; j < 8; ++j) {
-                uint32_t index = j + i * 8;
-                if (index >= entryList.size()) return;
-
-                // check if this field is present
-                if (bitmaskBytes[i] & (1 << j)) {
-                    // parse the entry
-                    DeltaValue value = parseEntry(bitBuffer, entryList[index]);
-
-                    // assign value if delta is provided
-                    if (delta) {
-                        delta->setEntryValue(index, value);
-                    }
-                }
+        // visit only the fields that are present
+        while (bitmask) {
+            uint32_t index = static_cast<uint32_t>(__builtin_ctzll(bitmask));
+            bitmask &= bitmask - 1;
+
+            // parse the entry
+            DeltaValue value = parseEntry(bitBuffer, entryList[index]);
+
+            // assign value if delta is provided
+            if (delta) {
+                delta->setEntryValue(index, value);
             }
         }
     }
@@ -231,7 +281,8 @@ private:
             return bitBuffer.readString();
         }
 
-        throw std::runtime_error("Unknown delta entry type");
+        bitBuffer.fail(DecodeError::UnknownDeltaType, static_cast<int32_t>(e.flags));
+        return DeltaValue{};
     }
 
     int32_t parseInt(BitBuffer& bitBuffer, const Entry& e) const {
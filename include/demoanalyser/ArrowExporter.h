@@ -0,0 +1,52 @@
+#pragma once
+
+#include <demoanalyser/ArrowStreamWriter.h>
+#include <demoanalyser/DemoEvent.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace demo_analyser
+{
+	// Event sink that fills Arrow columns straight from the decode path, one IPC stream
+	// file per table: <prefix>player_states.arrows, entity_updates, client_data, prints,
+	// console_commands and user_info. No row objects are built along the way. Text columns
+	// are binary: the game sends names, prints and userinfo as raw (often Latin-1) bytes.
+	//
+	//     ArrowExporter exporter("out/match1_");
+	//     parser.setEventSink(&exporter);
+	//     parser.parseDemo();
+	//     exporter.finish();
+	class ArrowExporter : public DemoEventSink
+	{
+		public:
+			static constexpr size_t DefaultBatchRows = 64 * 1024;
+
+			explicit ArrowExporter(const std::string& prefix, size_t batchRows = DefaultBatchRows);
+
+			// Flushes the partial batches and closes the streams; also done on destruction
+			void finish();
+			bool good() const;
+
+			// Paths of the streams written, one per table
+			const std::vector<std::string>& files() const { return paths; }
+
+			using DemoEventSink::handle;
+			void handle(DemoEventType type, float time, uint32_t frame, const std::string& text) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const PlayerState& state) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const ClientData& clientData) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const UpdateUserInfo& userInfo) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const EntityStatePlayer& entity) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const CustomEntityState& entity) override;
+
+		private:
+			std::unique_ptr<ArrowStreamWriter> playerStates;
+			std::unique_ptr<ArrowStreamWriter> entityUpdates;
+			std::unique_ptr<ArrowStreamWriter> clientData;
+			std::unique_ptr<ArrowStreamWriter> prints;
+			std::unique_ptr<ArrowStreamWriter> consoleCommands;
+			std::unique_ptr<ArrowStreamWriter> userInfo;
+			std::vector<std::string> paths;
+	};
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace demo_analyser
+{
+	// Binary holds bytes in no particular encoding; Utf8 values must be valid UTF-8
+	enum class ArrowType : uint8_t { UInt8, Int16, Int32, UInt32, Int64, Float32, Utf8, Binary };
+
+	struct ArrowColumnSpec
+	{
+		std::string Name;
+		ArrowType Type;
+	};
+
+	// Writes one table as an Apache Arrow IPC stream (schema message, record batches, end marker).
+	// Self-contained: the flatbuffer metadata is encoded by hand, no Arrow library needed.
+	//
+	// Values are appended column by column for each row and go straight into the column
+	// buffers; a record batch is written every batchRows rows.
+	class ArrowStreamWriter
+	{
+		public:
+			ArrowStreamWriter(const std::string& path, std::vector<ArrowColumnSpec> columns, size_t batchRows);
+			~ArrowStreamWriter();
+
+			ArrowStreamWriter(const ArrowStreamWriter&) = delete;
+			ArrowStreamWriter& operator=(const ArrowStreamWriter&) = delete;
+
+			template<typename T>
+			void append(size_t column, T value)
+			{
+				std::vector<uint8_t>& data = columns[column].Data;
+				size_t size = data.size();
+				data.resize(size + sizeof(T));
+				std::memcpy(data.data() + size, &value, sizeof(T));
+			}
+
+			void appendString(size_t column, const char* text, size_t length);
+			void appendString(size_t column, const std::string& text) { appendString(column, text.data(), text.size()); }
+
+			// Closes the row; every column must have had exactly one value appended
+			void endRow();
+
+			// Writes the last partial batch and the end-of-stream marker
+			void finish();
+
+			bool good() const { return static_cast<bool>(out); }
+			uint64_t rowsWritten() const { return totalRows; }
+
+		private:
+			struct Column
+			{
+				ArrowColumnSpec Spec;
+				std::vector<uint8_t> Data;
+				std::vector<int32_t> Offsets;  // Utf8 and Binary only, rows + 1 entries
+			};
+
+			void writeSchema();
+			void writeBatch();
+			void writeMessage(const std::vector<uint8_t>& metadata, const std::vector<std::pair<const void*, size_t>>& body);
+
+			std::ofstream out;
+			std::vector<Column> columns;
+			size_t batchRows;
+			size_t rows = 0;
+			uint64_t totalRows = 0;
+			bool finished = false;
+	};
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace demo_analyser
+{
+	// Append-only file output through one large user-space buffer and plain write(2) calls.
+	// Numbers are formatted in place with std::to_chars (shortest round-trip for floats).
+	class BufferedFileWriter
+	{
+		public:
+			static constexpr size_t DefaultCapacity = 1 << 20;
+
+			explicit BufferedFileWriter(const std::string& path, size_t capacity = DefaultCapacity);
+			~BufferedFileWriter();
+
+			BufferedFileWriter(const BufferedFileWriter&) = delete;
+			BufferedFileWriter& operator=(const BufferedFileWriter&) = delete;
+
+			void write(const char* data, size_t size);
+			void write(std::string_view text) { write(text.data(), text.size()); }
+
+			void put(char c)
+			{
+				if (used == buffer.size())
+					flush();
+				buffer[used++] = c;
+			}
+
+			template<typename T>
+			void number(T value)
+			{
+				// longest float/int64 text fits in 32 bytes
+				if (buffer.size() - used < 32)
+					flush();
+				auto result = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), value);
+				used = static_cast<size_t>(result.ptr - buffer.data());
+			}
+
+			void flush();
+			void close();
+
+			// False once opening or any write failed, stays valid after close()
+			bool good() const { return !failed; }
+
+		private:
+			int fd = -1;
+			bool failed = false;
+			std::vector<char> buffer;
+			size_t used = 0;
+	};
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace demo_analyser
+{
+	// Where DemoParser reads demo bytes from: a file, a buffer in memory, or a stream
+	class ByteSource
+	{
+		public:
+			virtual ~ByteSource() = default;
+
+			// Copies up to size bytes into dst and returns how many were read
+			virtual size_t read(void* dst, size_t size) = 0;
+			virtual bool seek(int64_t offset, std::ios_base::seekdir origin = std::ios::cur) = 0;
+			virtual int64_t tell() const = 0;
+
+			// Total size in bytes, or -1 when the source does not know it up front
+			virtual int64_t size() const = 0;
+
+			// Whether any offset can be reached, including the directory at the end of the demo
+			virtual bool seekable() const = 0;
+
+			// False once a read came up short or a seek could not be satisfied
+			bool good() const { return ok; }
+
+		protected:
+			bool ok = true;
+	};
+
+	// A demo that is already in memory. The buffer is borrowed unless the vector overload is used.
+	class MemoryByteSource : public ByteSource
+	{
+		public:
+			MemoryByteSource(const uint8_t* data, size_t size);
+			explicit MemoryByteSource(std::vector<uint8_t> data);
+
+			size_t read(void* dst, size_t size) override;
+			bool seek(int64_t offset, std::ios_base::seekdir origin = std::ios::cur) override;
+			int64_t tell() const override { return static_cast<int64_t>(position); }
+			int64_t size() const override { return static_cast<int64_t>(length); }
+			bool seekable() const override { return true; }
+
+			const uint8_t* data() const { return begin; }
+
+		protected:
+			MemoryByteSource() = default;
+			void setRange(const uint8_t* data, size_t size);
+
+		private:
+			std::vector<uint8_t> owned;
+			const uint8_t* begin = nullptr;
+			size_t length = 0;
+			size_t position = 0;
+	};
+
+	// A demo file mapped into memory
+	class MappedFileByteSource : public MemoryByteSource
+	{
+		public:
+			explicit MappedFileByteSource(const std::string& path);
+			~MappedFileByteSource() override;
+
+			MappedFileByteSource(const MappedFileByteSource&) = delete;
+			MappedFileByteSource& operator=(const MappedFileByteSource&) = delete;
+
+			bool isOpen() const { return mapping != nullptr; }
+
+		private:
+			void* mapping = nullptr;
+			size_t mappingSize = 0;
+	};
+
+	// Reads a forward-only producer in chunks and keeps a short window of bytes behind the
+	// cursor, so small backward seeks (frame length peeks) work without random access
+	class BufferedByteSource : public ByteSource
+	{
+		public:
+			static constexpr size_t DefaultChunkSize = 64 * 1024;
+			static constexpr size_t DefaultWindowSize = 4 * 1024;
+
+			size_t read(void* dst, size_t size) override;
+			bool seek(int64_t offset, std::ios_base::seekdir origin = std::ios::cur) override;
+			int64_t tell() const override { return position; }
+			int64_t size() const override { return -1; }
+			bool seekable() const override { return false; }
+
+		protected:
+			explicit BufferedByteSource(size_t chunkSize = DefaultChunkSize, size_t windowSize = DefaultWindowSize);
+
+			// Produces up to size further bytes, 0 at the end of the data
+			virtual size_t fill(uint8_t* dst, size_t size) = 0;
+
+			// Jumps the producer to an absolute offset, for sources that can; the buffer is reset on success
+			virtual bool seekRaw(int64_t) { return false; }
+
+			void resetBuffer(int64_t offset);
+
+		private:
+			bool refill();
+
+			std::vector<uint8_t> buffer;
+			size_t windowSize;
+			size_t bufferLength = 0;
+			int64_t bufferStart = 0;
+			int64_t position = 0;
+			bool exhausted = false;
+	};
+
+	// Any std::istream, seekable or not (pipes, sockets wrapped in a streambuf)
+	class StreamByteSource : public BufferedByteSource
+	{
+		public:
+			explicit StreamByteSource(std::istream& stream);
+			explicit StreamByteSource(const std::string& path);
+
+			int64_t size() const override { return streamSize; }
+			bool seekable() const override { return streamSize >= 0; }
+
+			bool isOpen() const { return stream != nullptr && !stream->fail(); }
+
+		protected:
+			size_t fill(uint8_t* dst, size_t size) override;
+			bool seekRaw(int64_t offset) override;
+
+		private:
+			void probeSize();
+
+			std::unique_ptr<std::istream> owned;
+			std::istream* stream = nullptr;
+			int64_t streamSize = -1;
+	};
+
+	// Maps the file when possible and falls back to buffered stream reads otherwise.
+	// Gzip-compressed demos are inflated on the fly when built with zlib.
+	// readAhead reads the file on a background thread instead (slow or network-mounted storage).
+	std::unique_ptr<ByteSource> OpenFileByteSource(const std::string& path, bool readAhead = false);
+}
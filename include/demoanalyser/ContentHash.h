@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace demo_analyser
+{
+	// Streaming XXH64, fast enough to key caches on the full contents of a demo
+	class ContentHasher
+	{
+		public:
+			explicit ContentHasher(uint64_t seed = 0);
+
+			void update(const void* data, size_t size);
+			uint64_t digest() const;
+
+		private:
+			uint64_t lanes[4];
+			uint8_t pending[32];
+			size_t pendingSize = 0;
+			uint64_t totalSize = 0;
+			uint64_t seed;
+	};
+
+	inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0)
+	{
+		ContentHasher hasher(seed);
+		hasher.update(data, size);
+		return hasher.digest();
+	}
+
+	// Hash of the file as stored on disk. Returns false if it cannot be read.
+	bool HashFile(const std::string& path, uint64_t& hash);
+}
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <HalfLifeDeltas.h>
 #include "EventHandlers.h"
 
@@ -14,8 +16,7 @@ inline ClientData toClientData(const HalfLifeDelta& delta)
 
     auto getInt = [&](const char* name) -> int {
         if (const DeltaValue* val = delta.findEntryValue(name)) {
-            if (auto ptr = std::get_if<int32_t>(val)) return *ptr;
-            if (auto ptr = std::get_if<uint32_t>(val)) return static_cast<int>(*ptr);
+            return toInt(*val);
         }
         return 0;
     };
@@ -86,12 +87,12 @@ inline EntityStatePlayer toEntityStatePlayer(const HalfLifeDelta& delta)
 {
     EntityStatePlayer e{};
 
-    auto getFloat = [&](const char* name){ return toFloat(*delta.findEntryValue(name)); };
+    auto getFloat = [&](const char* name){ 
+        if (const DeltaValue* val = delta.findEntryValue(name)) return toFloat(*val);
+        return 0.0f;
+    };
     auto getInt = [&](const char* name){ 
-        if (const DeltaValue* val = delta.findEntryValue(name)) {
-            if (auto p = std::get_if<int32_t>(val)) return *p;
-            if (auto p = std::get_if<uint32_t>(val)) return static_cast<int>(*p);
-        }
+        if (const DeltaValue* val = delta.findEntryValue(name)) return toInt(*val);
         return 0;
     };
     auto getVec3 = [&](const char* base, float out[3]){
@@ -132,8 +133,8 @@ inline EntityStatePlayer toEntityStatePlayer(const HalfLifeDelta& delta)
     e.spectator = getInt("spectator");
 
     // controller and blending
-    for(int i = 0; i < 4; ++i) e.controller[i] = static_cast<uint8_t>(getInt(("controller" + std::to_string(i)).c_str()));
-    for(int i = 0; i < 2; ++i) e.blending[i] = static_cast<uint8_t>(getInt(("blending" + std::to_string(i)).c_str()));
+    for(int i = 0; i < 4; ++i) e.controller[i] = static_cast<uint8_t>(getInt(("controller[" + std::to_string(i) + "]").c_str()));
+    for(int i = 0; i < 2; ++i) e.blending[i] = static_cast<uint8_t>(getInt(("blending[" + std::to_string(i) + "]").c_str()));
 
     e.rendercolor.r = static_cast<uint8_t>(getInt("rendercolor.r"));
     e.rendercolor.g = static_cast<uint8_t>(getInt("rendercolor.g"));
@@ -155,8 +156,7 @@ inline CustomEntityState toCustomEntityState(const HalfLifeDelta& delta)
 
     auto getInt = [&](const char* name) -> int {
         if (const DeltaValue* val = delta.findEntryValue(name)) {
-            if (auto ptr = std::get_if<int32_t>(val)) return *ptr;
-            if (auto ptr = std::get_if<uint32_t>(val)) return static_cast<int>(*ptr);
+            return toInt(*val);
         }
         return 0;
     };
@@ -191,6 +191,85 @@ inline CustomEntityState toCustomEntityState(const HalfLifeDelta& delta)
     return e;
 }
 
+inline WeaponData toWeaponData(const HalfLifeDelta& delta)
+{
+    WeaponData w{};
+
+    auto getFloat = [&](const char* name) -> float {
+        if (const DeltaValue* val = delta.findEntryValue(name)) {
+            return toFloat(*val);
+        }
+        return 0.0f;
+    };
+
+    auto getInt = [&](const char* name) -> int {
+        if (const DeltaValue* val = delta.findEntryValue(name)) {
+            return toInt(*val);
+        }
+        return 0;
+    };
+
+    w.m_iId = getInt("m_iId");
+    w.m_iClip = getInt("m_iClip");
+    w.m_flNextPrimaryAttack = getFloat("m_flNextPrimaryAttack");
+    w.m_flNextSecondaryAttack = getFloat("m_flNextSecondaryAttack");
+    w.m_flTimeWeaponIdle = getFloat("m_flTimeWeaponIdle");
+    w.m_fInReload = getInt("m_fInReload");
+    w.m_fInSpecialReload = getInt("m_fInSpecialReload");
+    w.m_flNextReload = getFloat("m_flNextReload");
+    w.m_flPumpTime = getFloat("m_flPumpTime");
+    w.m_fReloadTime = getFloat("m_fReloadTime");
+    w.m_fAimedDamage = getFloat("m_fAimedDamage");
+    w.m_fNextAimBonus = getFloat("m_fNextAimBonus");
+    w.m_fInZoom = getInt("m_fInZoom");
+    w.m_iWeaponState = getInt("m_iWeaponState");
+    w.iuser1 = getInt("iuser1");
+    w.iuser2 = getInt("iuser2");
+    w.iuser3 = getInt("iuser3");
+    w.fuser1 = getFloat("fuser1");
+    w.fuser2 = getFloat("fuser2");
+
+    return w;
+}
+
+inline ServerEventArgs toServerEventArgs(const HalfLifeDelta& delta)
+{
+    ServerEventArgs args{};
+
+    auto getFloat = [&](const char* name) -> float {
+        if (const DeltaValue* val = delta.findEntryValue(name)) {
+            return toFloat(*val);
+        }
+        return 0.0f;
+    };
+
+    auto getInt = [&](const char* name) -> int {
+        if (const DeltaValue* val = delta.findEntryValue(name)) {
+            return toInt(*val);
+        }
+        return 0;
+    };
+
+    auto getVec3 = [&](const char* baseName, float out[3]) {
+        out[0] = getFloat((std::string(baseName) + "[0]").c_str());
+        out[1] = getFloat((std::string(baseName) + "[1]").c_str());
+        out[2] = getFloat((std::string(baseName) + "[2]").c_str());
+    };
+
+    args.entindex = getInt("entindex");
+    getVec3("origin", args.origin);
+    getVec3("angles", args.angles);
+    args.ducking = getInt("ducking");
+    args.fparam1 = getFloat("fparam1");
+    args.fparam2 = getFloat("fparam2");
+    args.iparam1 = getInt("iparam1");
+    args.iparam2 = getInt("iparam2");
+    args.bparam1 = getInt("bparam1");
+    args.bparam2 = getInt("bparam2");
+
+    return args;
+}
+
 inline EventFrame ParseEventFrame(const std::vector<uint8_t>& data)
 {
     BitBuffer bitBuffer(data);
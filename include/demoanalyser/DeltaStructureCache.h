@@ -0,0 +1,57 @@
+#pragma once
+
+#include <HalfLifeDeltas.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace demo_analyser
+{
+	// FNV-1a over a raw SVC_DELTADESCRIPTION payload
+	inline uint64_t hashDeltaDescription(const uint8_t* data, size_t size)
+	{
+		uint64_t hash = DeltaFingerprintBasis;
+		for (size_t i = 0; i < size; ++i) {
+			hash ^= data[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	// Process-wide table of delta structures already built from a description payload.
+	// Structures are immutable once published, so every parser in the process can share them.
+	class DeltaStructureCache
+	{
+		public:
+			static constexpr size_t MaxEntries = 4096;
+
+			static DeltaStructureCache& instance();
+
+			// Returns the structure built from an identical payload, or nullptr
+			std::shared_ptr<const HalfLifeDeltaStructure> find(uint64_t hash, const uint8_t* payload, size_t size) const;
+
+			// Publishes a structure and returns the canonical one for this payload,
+			// which is an earlier insert if another parser got there first
+			std::shared_ptr<const HalfLifeDeltaStructure> insert(uint64_t hash, const uint8_t* payload, size_t size,
+				std::shared_ptr<const HalfLifeDeltaStructure> structure);
+
+			size_t size() const;
+			void clear();
+
+		private:
+			struct Entry
+			{
+				std::vector<uint8_t> Payload;
+				std::shared_ptr<const HalfLifeDeltaStructure> Structure;
+			};
+
+			std::shared_ptr<const HalfLifeDeltaStructure> findLocked(uint64_t hash, const uint8_t* payload, size_t size) const;
+
+			mutable std::shared_mutex mutex;
+			std::unordered_multimap<uint64_t, Entry> entries;
+	};
+}
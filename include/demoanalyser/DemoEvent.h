@@ -0,0 +1,199 @@
+#pragma once
+
+#include <demoanalyser/DemoStructs.h>
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace demo_analyser
+{
+	// One callback's worth of data, for the pull API (DemoParser::next) and event sinks
+	enum class DemoEventType : uint8_t {
+		Header,
+		Directory,
+		ConsoleCommand,           // std::string
+		PlayerState,
+		EventFrame,
+		TimeTick,                 // float
+		MessagePrint,             // std::string
+		ClientData,
+		NewMoveVars,
+		UpdateUserInfo,
+		ServerInfo,
+		SetAngle,
+		PackedPlayerEntity,       // EntityStatePlayer
+		PackedCustomEntity,       // CustomEntityState
+		DeltaPackedPlayerEntity,  // EntityStatePlayer
+		DeltaPackedCustomEntity,  // CustomEntityState
+		Diagnostic,               // ParseDiagnostic
+		WeaponData,               // WeaponDataUpdate
+		TempEntity,               // TempEntityBatch
+		ServerEvents,             // ServerEventBatch
+	};
+
+	inline const char* DemoEventTypeName(DemoEventType type)
+	{
+		switch (type)
+		{
+			case DemoEventType::Header:                  return "Header";
+			case DemoEventType::Directory:               return "Directory";
+			case DemoEventType::ConsoleCommand:          return "ConsoleCommand";
+			case DemoEventType::PlayerState:             return "PlayerState";
+			case DemoEventType::EventFrame:              return "EventFrame";
+			case DemoEventType::TimeTick:                return "TimeTick";
+			case DemoEventType::MessagePrint:            return "MessagePrint";
+			case DemoEventType::ClientData:              return "ClientData";
+			case DemoEventType::NewMoveVars:             return "NewMoveVars";
+			case DemoEventType::UpdateUserInfo:          return "UpdateUserInfo";
+			case DemoEventType::ServerInfo:              return "ServerInfo";
+			case DemoEventType::SetAngle:                return "SetAngle";
+			case DemoEventType::PackedPlayerEntity:      return "PackedPlayerEntity";
+			case DemoEventType::PackedCustomEntity:      return "PackedCustomEntity";
+			case DemoEventType::DeltaPackedPlayerEntity: return "DeltaPackedPlayerEntity";
+			case DemoEventType::DeltaPackedCustomEntity: return "DeltaPackedCustomEntity";
+			case DemoEventType::Diagnostic:              return "Diagnostic";
+			case DemoEventType::WeaponData:              return "WeaponData";
+			case DemoEventType::TempEntity:              return "TempEntity";
+			case DemoEventType::ServerEvents:            return "ServerEvents";
+		}
+		return "Unknown";
+	}
+
+	// Whether events of type carry a T payload
+	template<typename T>
+	constexpr bool DemoEventCarries(DemoEventType type)
+	{
+		switch (type)
+		{
+			case DemoEventType::Header:
+			case DemoEventType::Directory:               return std::is_same_v<T, DemoHeader>;
+			case DemoEventType::ConsoleCommand:
+			case DemoEventType::MessagePrint:            return std::is_same_v<T, std::string>;
+			case DemoEventType::PlayerState:             return std::is_same_v<T, PlayerState>;
+			case DemoEventType::EventFrame:              return std::is_same_v<T, EventFrame>;
+			case DemoEventType::TimeTick:                return std::is_same_v<T, float>;
+			case DemoEventType::ClientData:              return std::is_same_v<T, ClientData>;
+			case DemoEventType::NewMoveVars:             return std::is_same_v<T, MoveVars>;
+			case DemoEventType::UpdateUserInfo:          return std::is_same_v<T, UpdateUserInfo>;
+			case DemoEventType::ServerInfo:              return std::is_same_v<T, ServerInfo>;
+			case DemoEventType::SetAngle:                return std::is_same_v<T, Angle>;
+			case DemoEventType::PackedPlayerEntity:
+			case DemoEventType::DeltaPackedPlayerEntity: return std::is_same_v<T, EntityStatePlayer>;
+			case DemoEventType::PackedCustomEntity:
+			case DemoEventType::DeltaPackedCustomEntity: return std::is_same_v<T, CustomEntityState>;
+			case DemoEventType::Diagnostic:              return std::is_same_v<T, ParseDiagnostic>;
+			case DemoEventType::WeaponData:              return std::is_same_v<T, WeaponDataUpdate>;
+			case DemoEventType::TempEntity:              return std::is_same_v<T, TempEntityBatch>;
+			case DemoEventType::ServerEvents:            return std::is_same_v<T, ServerEventBatch>;
+		}
+		return false;
+	}
+
+	struct DemoEvent
+	{
+		DemoEventType Type;
+		float Timestamp = 0.0f;    // of the frame the event came from
+		uint32_t FrameNumber = 0;
+
+		// Payload held by the parser, valid as long as the event; Type gives its struct
+		// (DemoEventCarries)
+		const void* Data = nullptr;
+
+		// T must be the payload struct of Type, checked in debug builds
+		template<typename T>
+		const T& as() const
+		{
+			assert(DemoEventCarries<T>(Type));
+			return *static_cast<const T*>(Data);
+		}
+	};
+
+	// Receives events by reference straight from the decode path, with no copy per event.
+	// Set with DemoParser::setEventSink, it replaces the global callbacks for that parser.
+	// Override the overloads for the payloads of interest; type tells apart events that
+	// share a payload type.
+	class DemoEventSink
+	{
+		public:
+			virtual ~DemoEventSink() = default;
+
+			virtual void handle(DemoEventType, float, uint32_t, const DemoHeader&) {}
+			virtual void handle(DemoEventType, float, uint32_t, const std::string&) {}
+			virtual void handle(DemoEventType, float, uint32_t, const PlayerState&) {}
+			virtual void handle(DemoEventType, float, uint32_t, const EventFrame&) {}
+			virtual void handle(DemoEventType, float, uint32_t, float) {}
+			virtual void handle(DemoEventType, float, uint32_t, const ClientData&) {}
+			virtual void handle(DemoEventType, float, uint32_t, const MoveVars&) {}
+			virtual void handle(DemoEventType, float, uint32_t, const UpdateUserInfo&) {}
+			virtual void handle(DemoEventType, float, uint32_t, const ServerInfo&) {}
+			virtual void handle(DemoEventType, float, uint32_t, const Angle&) {}
+			virtual void handle(DemoEventType, float, uint32_t, const EntityStatePlayer&) {}
+			virtual void handle(DemoEventType, float, uint32_t, const CustomEntityState&) {}
+			virtual void handle(DemoEventType, float, uint32_t, const ParseDiagnostic&) {}
+			virtual void handle(DemoEventType, float, uint32_t, const WeaponDataUpdate&) {}
+			virtual void handle(DemoEventType, float, uint32_t, const TempEntityBatch&) {}
+			virtual void handle(DemoEventType, float, uint32_t, const ServerEventBatch&) {}
+	};
+
+	// Sends every event to the global weak callbacks, as a parser with no sink does.
+	// Lets code written against the sink interface (event log replay, tee sinks) feed
+	// handlers written as callbacks.
+	class CallbackEventSink : public DemoEventSink
+	{
+		public:
+			void handle(DemoEventType type, float time, uint32_t frame, const DemoHeader& header) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const std::string& text) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const PlayerState& state) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const EventFrame& eventFrame) override;
+			void handle(DemoEventType type, float time, uint32_t frame, float value) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const ClientData& clientData) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const MoveVars& moveVars) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const UpdateUserInfo& userInfo) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const ServerInfo& serverInfo) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const Angle& angle) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const EntityStatePlayer& entity) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const CustomEntityState& entity) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const ParseDiagnostic& diagnostic) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const WeaponDataUpdate& weaponData) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const TempEntityBatch& tempEntities) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const ServerEventBatch& serverEvents) override;
+	};
+
+	// Passes every event on to several sinks (not owned), in the order they were added
+	class FanOutEventSink : public DemoEventSink
+	{
+		public:
+			void add(DemoEventSink* sink) { sinks.push_back(sink); }
+			bool empty() const { return sinks.empty(); }
+
+			void handle(DemoEventType type, float time, uint32_t frame, const DemoHeader& header) override { forward(type, time, frame, header); }
+			void handle(DemoEventType type, float time, uint32_t frame, const std::string& text) override { forward(type, time, frame, text); }
+			void handle(DemoEventType type, float time, uint32_t frame, const PlayerState& state) override { forward(type, time, frame, state); }
+			void handle(DemoEventType type, float time, uint32_t frame, const EventFrame& eventFrame) override { forward(type, time, frame, eventFrame); }
+			void handle(DemoEventType type, float time, uint32_t frame, float value) override { forward(type, time, frame, value); }
+			void handle(DemoEventType type, float time, uint32_t frame, const ClientData& clientData) override { forward(type, time, frame, clientData); }
+			void handle(DemoEventType type, float time, uint32_t frame, const MoveVars& moveVars) override { forward(type, time, frame, moveVars); }
+			void handle(DemoEventType type, float time, uint32_t frame, const UpdateUserInfo& userInfo) override { forward(type, time, frame, userInfo); }
+			void handle(DemoEventType type, float time, uint32_t frame, const ServerInfo& serverInfo) override { forward(type, time, frame, serverInfo); }
+			void handle(DemoEventType type, float time, uint32_t frame, const Angle& angle) override { forward(type, time, frame, angle); }
+			void handle(DemoEventType type, float time, uint32_t frame, const EntityStatePlayer& entity) override { forward(type, time, frame, entity); }
+			void handle(DemoEventType type, float time, uint32_t frame, const CustomEntityState& entity) override { forward(type, time, frame, entity); }
+			void handle(DemoEventType type, float time, uint32_t frame, const ParseDiagnostic& diagnostic) override { forward(type, time, frame, diagnostic); }
+			void handle(DemoEventType type, float time, uint32_t frame, const WeaponDataUpdate& weaponData) override { forward(type, time, frame, weaponData); }
+			void handle(DemoEventType type, float time, uint32_t frame, const TempEntityBatch& tempEntities) override { forward(type, time, frame, tempEntities); }
+			void handle(DemoEventType type, float time, uint32_t frame, const ServerEventBatch& serverEvents) override { forward(type, time, frame, serverEvents); }
+
+		private:
+			template<typename T>
+			void forward(DemoEventType type, float time, uint32_t frame, const T& value)
+			{
+				for (DemoEventSink* sink : sinks)
+					sink->handle(type, time, frame, value);
+			}
+
+			std::vector<DemoEventSink*> sinks;
+	};
+}
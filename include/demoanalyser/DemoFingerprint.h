@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace demo_analyser
+{
+	// Identity of a demo for deduplication, computed without a full decode: only the header
+	// and the loading segment up to SVC_SERVERINFO are parsed.
+	struct DemoFingerprint
+	{
+		// Same server session: header fields (protocols, map, game folder, map checksum) and
+		// the SVC_SERVERINFO payload minus the recording player's slot. Every player's POV
+		// demo of one match shares it.
+		uint64_t Match = 0;
+
+		// Same recording: Match plus the player slot, the demo size and 4 KiB windows of raw
+		// bytes every 256 KiB of game data. Re-uploads, renamed and compressed copies share it.
+		uint64_t Content = 0;
+
+		bool Valid = false;
+		std::string Error;  // why the demo could not be fingerprinted, when !Valid
+	};
+
+	DemoFingerprint FingerprintDemo(const std::string& path);
+
+	// Fingerprints every path on a pool of threads (0 = hardware concurrency); results are in
+	// the order of paths
+	std::vector<DemoFingerprint> FingerprintDemos(const std::vector<std::string>& paths, unsigned threads = 0);
+
+	enum class DemoGrouping : uint8_t { Content, Match };
+
+	// Indices of valid fingerprints sharing a key, for every key held by more than one demo.
+	// Groups are ordered by their first member, members by index.
+	std::vector<std::vector<size_t>> GroupDemos(const std::vector<DemoFingerprint>& fingerprints, DemoGrouping by);
+}
@@ -1,12 +1,20 @@
 #include <BitBuffer.h>
 #include <HalfLifeDeltas.h>
+#include <demoanalyser/ByteSource.h>
+#include <demoanalyser/DemoEvent.h>
+#include <demoanalyser/DemoStructs.h>
+#include <demoanalyser/ParseRequest.h>
+#include <demoanalyser/PlayerTable.h>
+#include <demoanalyser/ResourceTable.h>
 
+#include <array>
 #include <cstdint>
-#include <fstream>
+#include <deque>
 #include <functional>
 #include <ios>
 #include <iostream>
 #include <memory>
+#include <tuple>
 #include <vector>
 
 namespace demo_analyser
@@ -166,33 +174,179 @@ namespace demo_analyser
         int8_t Length;
 	};
 
+	// A delta structure the message handlers decode by name, resolved once at registration
+	struct DeltaSlot
+	{
+		const HalfLifeDeltaStructure* Structure = nullptr;
+		bool KnownLayout = false;  // matches the stock layout, decoded by the specialized path
+	};
+
+	// For use inside a callback: stops the parse running on this thread (e.g. wrong map in
+	// OnReadHeader, wrong server in OnServerInfo). No callback runs after it; decoding ends
+	// after the current message, whose remaining events and the frame's batches are dropped.
+	void StopParsing();
+
+	// For use inside a callback: the player table of the parse running on this thread, nullptr
+	// outside of a parse
+	const PlayerTable* CurrentPlayers();
+
+	// For use inside a callback: the resource list of the parse running on this thread, to
+	// resolve model and sound indices; nullptr outside of a parse
+	const ResourceTable* CurrentResources();
+
 	class DemoParser
     {
 		public:
 			DemoParser(const std::string& path);
+			DemoParser(const uint8_t* data, size_t size);  // borrows the buffer for the parser's lifetime
+			explicit DemoParser(std::unique_ptr<ByteSource> source);
+
+			ParseStatus parseDemo();
+			ParseStatus parseDemo(const ParseRequest& request);
+
+			// Ends the running parse as StopParsing() does, parseDemo returns ParseStatus::Stopped
+			void requestStop() { stopRequested = true; emitEvents = false; }
+
+			// Pull-style alternative to parseDemo: decodes one frame at a time and hands out its
+			// events in order, instead of calling the global callbacks. The event and its payload
+			// stay valid until the next call; nullptr once the parse is over (see getStatus).
+			void beginEvents(const ParseRequest& request = ParseRequest());
+			const DemoEvent* next();
+			ParseStatus getStatus() const { return status; }
 
-			void parseDemo();
+			// Sends events to sink (not owned) instead of the global callbacks, nullptr to restore them
+			void setEventSink(DemoEventSink* sink) { eventSink = sink; }
+
+			// Skip game data frames that fail to decode instead of aborting the parse
+			void setRecoverErrors(bool enabled) { recoverErrors = enabled; }
+			// Frames skipped by the current (or last) parse
+			const std::vector<ParseDiagnostic>& getDiagnostics() const { return diagnostics; }
+
+			// Players by slot, user ID or Steam ID, as of the last SVC_UPDATEUSERINFO decoded
+			const PlayerTable& getPlayers() const { return players; }
+
+			// Resource names by type and index (modelindex, weaponmodel, sound index), from SVC_RESOURCELIST
+			const ResourceTable& getResources() const { return resources; }
+
+			// The recording client's weapons by slot, as of the last clientdata message
+			const std::array<WeaponData, MAX_WEAPONS>& getWeapons() const { return weapons; }
 
 		private:
-			std::ifstream file;
+			std::unique_ptr<ByteSource> source;
 			std::unique_ptr<BitBuffer> bitBuffer;
-			std::unordered_map<std::string, std::unique_ptr<HalfLifeDeltaStructure>> deltaDecoderTable;
+			std::unordered_map<std::string, std::shared_ptr<const HalfLifeDeltaStructure>> deltaDecoderTable;
 			std::unordered_map<uint8_t, MessageHandler> messageHandlerTable;
 
 			std::unordered_map<std::string, UserMessage> userMessageTable;
 
+			DeltaSlot entityStatePlayerDelta;
+			DeltaSlot entityStateDelta;
+			DeltaSlot customEntityStateDelta;
+			DeltaSlot clientDataDelta;
+			DeltaSlot weaponDataDelta;
+			DeltaSlot eventDelta;
+
+			// Last decoded state by entity number, kept up to date for every entity message, wanted
+			// or not: delta-packed updates only carry what changed
+			std::vector<EntityStatePlayer> playerEntities;
+			std::vector<CustomEntityState> customEntities;
+
+			PlayerTable players;
+			ResourceTable resources;
+
+			// Last decoded weapon_data_t by weapon slot; weaponUpdate is the batch being emitted
+			std::array<WeaponData, MAX_WEAPONS> weapons{};
+			WeaponDataUpdate weaponUpdate;
+
+			// SVC_TEMPENTITY effects of the current frame, emitted as one batch when it ends
+			TempEntityBatch tempEntities;
+
+			// SVC_EVENT / SVC_EVENT_RELIABLE events of the current frame; the batch emitted when
+			// it ends points into serverEvents
+			std::array<ServerEvent, MAX_FRAME_EVENTS> serverEvents{};
+			ServerEventBatch serverEventBatch;
+
 			int maxClients;
 			int frames = 0;
 			bool serverInfoParsed = false;
 
 			bool readingGameData = false;
-			void readDemoHeader(std::ifstream &file, const std::vector<uint8_t>& headerData, const uint32_t fileSize);
+
+			ParseRequest request;
+			bool frameEvents = true;  // current frame is wanted by the request
+			bool emitEvents = true;   // current message is wanted, handlers only decode otherwise
+			bool stopRequested = false;
+			uint8_t currentDirectory = 0;
+			FrameHeader currentFrame{};
+			ParseStatus status = ParseStatus::Completed;
+
+			DemoEventSink* eventSink = nullptr;
+
+			// pull mode: events of the current frame, handed out by next()
+			bool pullMode = false;
+			bool pullStarted = false;
+			bool pullFinished = false;
+			std::vector<DemoEvent> events;
+			size_t eventCursor = 0;
+
+			// Payloads of the current frame's events, one pool per type. Handlers decode into
+			// locals and reused slots, so each event keeps its own copy; elements are assigned
+			// over from frame to frame and keep their capacity.
+			template<typename T>
+			struct PayloadPool
+			{
+				std::deque<T> items;  // stable addresses as the frame's events are added
+				size_t used = 0;
+
+				const T& store(const T& value)
+				{
+					if (used == items.size())
+						items.push_back(value);
+					else
+						items[used] = value;
+					return items[used++];
+				}
+			};
+
+			std::tuple<PayloadPool<DemoHeader>, PayloadPool<std::string>, PayloadPool<PlayerState>, PayloadPool<EventFrame>,
+				PayloadPool<float>, PayloadPool<ClientData>, PayloadPool<MoveVars>, PayloadPool<UpdateUserInfo>,
+				PayloadPool<ServerInfo>, PayloadPool<Angle>, PayloadPool<EntityStatePlayer>, PayloadPool<CustomEntityState>,
+				PayloadPool<ParseDiagnostic>, PayloadPool<WeaponDataUpdate>, PayloadPool<TempEntityBatch>,
+				PayloadPool<ServerEventBatch>> payloads;
+
+			void beginParse(const ParseRequest& request);
+			bool parseFrame();
+
+			// Handlers call these instead of the callbacks: queued in pull mode, pushed otherwise
+			template<typename Callback>
+			bool Wants(Callback* callback) const { return emitEvents && (pullMode || eventSink || callback != nullptr); }
+
+			template<typename Callback, typename T>
+			void Emit(DemoEventType type, Callback* callback, T& value);
+
+			DemoHeader demoHeader;
+			bool directoryPending = false;  // forward-only source, directory read when the frames end
+
+			bool recoverErrors = false;
+			std::vector<ParseDiagnostic> diagnostics;
+			uint8_t currentMessageId = 0;
+			uint32_t currentMessageOffset = 0;
+
+			void RecordDiagnostic(int64_t frameOffset, const FrameHeader& frameHeader, const std::string& error,
+				DecodeError code = DecodeError::None, size_t errorBit = 0);
+			void readDemoHeader(const std::vector<uint8_t>& headerData, const int64_t fileSize);
+			void readDemoDirectory();
+			void readPendingDirectory();
 			FrameHeader ReadFrameHeader();
 			GameDataFrameHeader ReadGameDataFrameHeader();
-			void ParseGameDataMessages(const std::vector<uint8_t>& frameData);
+			bool ParseGameDataMessages(const std::vector<uint8_t>& frameData);
+			void EmitFrameBatches();
+			void ClearFrameBatches();
+			std::string DescribeDecodeError() const;
 			
 			void MessageClientData();
 			void MessageDeltaDescription();
+			std::shared_ptr<const HalfLifeDeltaStructure> ReadDeltaDescription();
 			void MessagePrint();
 			void MessageServerInfo();
 			void MessageExtraInfo();
@@ -211,6 +365,10 @@ namespace demo_analyser
 			void MessageSendCvarValue2();
 			void MessagePacketEntities();
 			void MessageTempEntity();
+			void MessageEvent();
+			void MessageEventReliable();
+			ServerEvent& QueueServerEvent(ServerEvent& discarded);
+			void ReadServerEventArgs(ServerEvent& event, bool wanted);
 			void MessageDeltaPacketEntities();
 			void MessageSound();
 			void MessagePing();
@@ -226,19 +384,30 @@ namespace demo_analyser
 			std::string FindMessageIdString(uint8_t id);
 			
 
-			void AddDeltaStructure(std::unique_ptr<HalfLifeDeltaStructure> structure)
+			void AddDeltaStructure(std::shared_ptr<const HalfLifeDeltaStructure> structure)
 			{
 				const std::string& name = structure->getName();
+				const HalfLifeDeltaStructure* registered = structure.get();
 
 				// Overwrite existing delta structure if it already exists
 				deltaDecoderTable[name] = std::move(structure);
+
+				BindDeltaSlot(registered);
 			}
 
-			HalfLifeDeltaStructure* GetDeltaStructure(const std::string& name)
+			void BindDeltaSlot(const HalfLifeDeltaStructure* structure);
+
+			template <typename Layout>
+			void ReadDelta(const DeltaSlot& slot, typename Layout::Target& out);
+
+			template <typename Layout>
+			void SkipDelta(const DeltaSlot& slot);
+
+			const HalfLifeDeltaStructure* GetDeltaStructure(const std::string& name)
 			{
 				auto it = deltaDecoderTable.find(name);
 				if (it == deltaDecoderTable.end())
-					throw std::runtime_error("Delta structure \"" + name + "\" not found.");
+					return nullptr;
 
 				return it->second.get();
 			}
@@ -0,0 +1,151 @@
+#pragma once
+
+// Stable C interface to the parser, for use from other languages (Go, Rust, ...).
+//
+// Events are fetched in batches into arrays the caller allocates and owns, so one call
+// crosses the FFI boundary for thousands of events. Nothing is called back across the
+// boundary and no C++ object changes hands: the parser is an opaque handle, and every
+// struct below has a fixed layout made of fixed-width fields.
+//
+//     demo_parser* parser = demo_parser_open_file("match.dem", error, sizeof(error));
+//     demo_player_state states[4096];
+//     demo_batch batch = {0};
+//     batch.player_states = states;
+//     batch.player_states_capacity = 4096;
+//     while (demo_parser_read_batch(parser, &batch) > 0)
+//         use(batch.player_states, batch.player_states_count);
+//     demo_parser_close(parser);
+//
+// No exception leaves these functions; failures are reported through return values and
+// demo_parser_error().
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DEMO_C_API_VERSION 1
+
+typedef struct demo_parser demo_parser;
+
+// demo_parser_status()
+enum {
+	DEMO_STATUS_RUNNING = 0,            // events left to read
+	DEMO_STATUS_COMPLETED = 1,          // end of the demo or of the time range
+	DEMO_STATUS_STOPPED = 2,
+	DEMO_STATUS_CANCELLED = 3,
+	DEMO_STATUS_DEADLINE_EXCEEDED = 4,
+	DEMO_STATUS_FAILED = 5,             // decode error, see demo_parser_error()
+};
+
+// demo_entity_update.kind
+enum {
+	DEMO_ENTITY_PLAYER = 0,
+	DEMO_ENTITY_CUSTOM = 1,
+};
+
+// demo_text_event.kind
+enum {
+	DEMO_TEXT_CONSOLE_COMMAND = 0,
+	DEMO_TEXT_PRINT = 1,
+};
+
+typedef struct demo_player_state {
+	uint32_t frame;
+	float time;
+	float position[3];
+	float rotation[3];
+	uint32_t weapon_flags;
+	float fov;
+} demo_player_state;
+
+// Packet entity updates, players and custom entities alike; fields a kind does not have
+// are zero. Values are the entity's full state after the update.
+typedef struct demo_entity_update {
+	uint32_t frame;
+	float time;
+	uint32_t entity;
+	uint8_t kind;       // DEMO_ENTITY_*
+	uint8_t delta;      // 1 for a delta-packed update
+	uint8_t reserved[2];
+	float origin[3];
+	float angles[3];
+	int32_t model_index;
+	int32_t sequence;
+	int32_t gait_sequence;
+	int32_t weapon_model;
+	int32_t team;
+	int32_t move_type;
+	int32_t effects;
+	int32_t skin;
+	int32_t body;
+	int32_t render_mode;
+	int32_t render_amount;
+	int32_t render_fx;
+	float anim_frame;
+	float frame_rate;
+	float scale;
+} demo_entity_update;
+
+// Console commands and server prints; the text lives in demo_batch.text at
+// [text_offset, text_offset + text_length), not NUL-terminated
+typedef struct demo_text_event {
+	uint32_t frame;
+	float time;
+	uint8_t kind;       // DEMO_TEXT_*
+	uint8_t truncated;  // text did not fit an empty text buffer and was cut
+	uint8_t reserved[2];
+	uint32_t text_offset;
+	uint32_t text_length;
+} demo_text_event;
+
+// Caller-owned output arrays. Set the pointers and capacities once; every read resets
+// the counts and fills the arrays until one of them is full or the demo ends. An array
+// left NULL (or with no capacity) means those events are not wanted and are skipped.
+typedef struct demo_batch {
+	demo_player_state* player_states;
+	size_t player_states_capacity;
+	size_t player_states_count;
+
+	demo_entity_update* entity_updates;
+	size_t entity_updates_capacity;
+	size_t entity_updates_count;
+
+	demo_text_event* texts;
+	size_t texts_capacity;
+	size_t texts_count;
+
+	char* text;
+	size_t text_capacity;
+	size_t text_size;
+} demo_batch;
+
+// NULL on failure, with the reason copied into error (may be NULL)
+demo_parser* demo_parser_open_file(const char* path, char* error, size_t error_size);
+
+// Borrows data until demo_parser_close
+demo_parser* demo_parser_open_memory(const uint8_t* data, size_t size, char* error, size_t error_size);
+
+void demo_parser_close(demo_parser* parser);
+
+// Only demo time within [start, end] is read; call before the first read
+int demo_parser_set_time_range(demo_parser* parser, float start, float end);
+
+// Number of events written into the batch; 0 once the parse is over (see
+// demo_parser_status), -1 on invalid arguments
+long demo_parser_read_batch(demo_parser* parser, demo_batch* batch);
+
+int demo_parser_status(const demo_parser* parser);
+
+// Reason of a DEMO_STATUS_FAILED parse or of the last rejected call, "" otherwise.
+// Valid until the next call on the parser.
+const char* demo_parser_error(const demo_parser* parser);
+
+// Map name from the demo header, "" before the first read
+const char* demo_parser_map_name(const demo_parser* parser);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,10 @@
+#pragma once
+
+#include <DecodeError.h>
+
 #include <cstdint>
 #include <string>
+#include <vector>
 
 struct DemoHeader {
 	uint32_t networkProtocol = 0;
@@ -116,6 +121,61 @@ struct ClientData {
     float vuser4[3];
 };
 
+// weapon_data_t, the recording client's per-weapon prediction state sent with clientdata
+struct WeaponData {
+    int m_iId;
+    int m_iClip;
+
+    float m_flNextPrimaryAttack;
+    float m_flNextSecondaryAttack;
+    float m_flTimeWeaponIdle;
+
+    int m_fInReload;
+    int m_fInSpecialReload;
+    float m_flNextReload;
+    float m_flPumpTime;
+    float m_fReloadTime;
+
+    float m_fAimedDamage;
+    float m_fNextAimBonus;
+    int m_fInZoom;
+    int m_iWeaponState;
+
+    int iuser1;
+    int iuser2;
+    int iuser3;
+    float fuser1;
+    float fuser2;
+
+    uint32_t weaponIndex;  // slot from the clientdata message, not part of the delta
+};
+
+#define MAX_WEAPONS 64 // the weapon slot is sent in 6 bits
+
+// Weapons updated by one clientdata message, each with its full state after the update
+struct WeaponDataUpdate {
+    std::vector<WeaponData> weapons;
+};
+
+#define MAX_TEMPENTITY_VALUES 17 // TE_BEAMPOINTS and the beam rings have the most fields
+
+// One SVC_TEMPENTITY effect. values holds the message fields in the order the server writes
+// them (the layouts in TempEntityLayouts.h): coords in world units, angles in degrees, bytes
+// and shorts as sent.
+struct TempEntity {
+    uint8_t type;          // TE_* number
+    uint8_t valueCount;
+    uint16_t textLength;   // TE_TEXTMESSAGE text in TempEntityBatch::text
+    uint32_t textOffset;
+    float values[MAX_TEMPENTITY_VALUES];
+};
+
+// Temp entities of one frame, in message order
+struct TempEntityBatch {
+    std::vector<TempEntity> entities;
+    std::string text;  // TE_TEXTMESSAGE texts back to back
+};
+
 struct EventFrame {
 	int flags;
 	int index;
@@ -137,6 +197,41 @@ struct EventFrame {
 	} args;
 };
 
+// event_args_t as sent in SVC_EVENT / SVC_EVENT_RELIABLE (event_t in delta.lst), fields named
+// as the delta entries
+struct ServerEventArgs {
+    int entindex;
+    float origin[3];
+    float angles[3];
+    int ducking;
+    float fparam1;
+    float fparam2;
+    int iparam1;
+    int iparam2;
+    int bparam1;
+    int bparam2;
+};
+
+// One event fired by the server (weapon fire, footsteps, ...)
+struct ServerEvent {
+    uint32_t eventIndex;    // EventScript resource index, e.g. "events/ak47.sc"
+    int32_t packetIndex;    // SVC_EVENT: slot in the frame's packet entities, -1 when not sent
+    float delay;            // seconds after the frame the client fires it
+    uint8_t reliable;       // sent as SVC_EVENT_RELIABLE
+    uint8_t hasArgs;        // args were sent; zero otherwise
+    ServerEventArgs args;   // decoded against zeros, not the previous event
+};
+
+#define MAX_FRAME_EVENTS 64 // MAX_EVENT_QUEUE, the client's event queue
+
+// Events of one frame, in message order. events points into storage owned by whoever emits
+// the batch and stays valid until the next frame is read.
+struct ServerEventBatch {
+    const ServerEvent* events = nullptr;
+    uint32_t count = 0;
+    uint32_t dropped = 0;   // events past MAX_FRAME_EVENTS, which the client drops too
+};
+
 struct Color {
     uint8_t r, g, b;
 };
@@ -184,6 +279,8 @@ struct EntityStatePlayer {
     
     float basevelocity[3];
     int spectator;
+
+    uint32_t entityNumber;  // from the packet entities message, not part of the delta
 };
 
 struct CustomEntityState {
@@ -204,6 +301,8 @@ struct CustomEntityState {
     
     float frame;
     float animtime; // note: post multiplier applied
+
+    uint32_t entityNumber;  // from the packet entities message, not part of the delta
 };
 
 struct MoveVars{ 
@@ -239,4 +338,17 @@ struct Angle {
     int16_t pitch;
     int16_t yaw;
     int16_t roll;
-};
\ No newline at end of file
+};
+
+// A game data frame that failed to decode and was skipped in recoverable mode
+struct ParseDiagnostic {
+    int64_t frameOffset;      // file offset of the frame header
+    uint32_t frameNumber;
+    float timestamp;
+    uint8_t frameType;
+    uint8_t messageId;        // message that was being decoded when it failed
+    uint32_t messageOffset;   // byte offset of that message inside the frame
+    DecodeError code;         // None when the frame failed with an exception
+    uint32_t errorBit;        // bit offset inside the frame where decoding stopped
+    std::string error;
+};
@@ -5,6 +5,7 @@
 #include <string>
 
 extern void OnReadHeader(const DemoHeader demoHeader) __attribute__((weak));
+extern void OnReadDirectory(const DemoHeader& demoHeader) __attribute__((weak)); // forward-only sources, after the last frame
 extern void OnConsoleCommand(const std::string& command) __attribute__((weak)); // FRAME TYPE 3
 extern void OnPlayerState(PlayerState& playerState) __attribute__((weak));      // FRAME TYPE 4
 extern void OnEventFrame(const EventFrame& eventFrame) __attribute__((weak));   // FRAME TYPE 6
@@ -14,6 +15,9 @@ extern void OnEventFrame(const EventFrame& eventFrame) __attribute__((weak));
 extern void OnTimeTick(float Time) __attribute__((weak));
 extern void OnMessagePrint(const std::string& message) __attribute__((weak));
 extern void OnClientData(ClientData& clientData) __attribute__((weak));
+extern void OnWeaponData(const WeaponDataUpdate& weaponData) __attribute__((weak)); // weapons updated by one clientdata message
+extern void OnTempEntity(const TempEntityBatch& tempEntities) __attribute__((weak)); // SVC_TEMPENTITY effects of one frame
+extern void OnServerEvents(const ServerEventBatch& serverEvents) __attribute__((weak)); // SVC_EVENT / SVC_EVENT_RELIABLE events of one frame
 extern void OnNewMoveVars(MoveVars& moveVars) __attribute__((weak));
 extern void OnUpdateUserInfo(UpdateUserInfo& updateUserInfo) __attribute__((weak));
 extern void OnServerInfo(ServerInfo& serverInfo) __attribute__((weak));
@@ -24,4 +28,5 @@ extern void OnPackedCustomEntity(CustomEntityState customEntityState)  __attribu
 extern void OnDeltaPackedPlayerEntity(EntityStatePlayer entityStatePlayer)  __attribute__((weak));
 extern void OnDeltaPackedCustomEntity(CustomEntityState customEntityState)  __attribute__((weak));
 
-
+// DIAGNOSTICS
+extern void OnParseDiagnostic(const ParseDiagnostic& diagnostic) __attribute__((weak));
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <demoanalyser/BufferedFileWriter.h>
+#include <demoanalyser/ByteSource.h>
+#include <demoanalyser/DemoEvent.h>
+#include <demoanalyser/ParseRequest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace demo_analyser
+{
+	// Decoded events of one demo saved as a flat binary log, so later analyses replay them
+	// with sequential memory reads instead of decoding the demo again.
+	//
+	// Layout (native byte order and struct layouts, checked by a fingerprint in the header):
+	//   header    "HLEV", version, layout fingerprint, hash of the source demo
+	//   records   16-byte record header (type, time, frame, payload size) and a payload of a
+	//             fixed size per event type, padded to 8 bytes. Plain structs are stored as
+	//             is; strings, and structs holding strings, point into the string table.
+	//             Weapon data batches are stored as an array of WeaponData, temp entity batches
+	//             as their count and text size, the TempEntity array and the text, server
+	//             event batches as their dropped count and the ServerEvent array.
+	//   strings   every distinct string once
+	//   trailer   record count, string table position, parse status, "HLEV"
+	//
+	// The log is written to <path>.tmp and renamed into place by finish(), so a log that
+	// exists is always complete.
+	class EventLogWriter : public DemoEventSink
+	{
+		public:
+			// Every event is also passed on to forward, when given
+			EventLogWriter(const std::string& path, uint64_t sourceHash, DemoEventSink* forward = nullptr);
+			~EventLogWriter() override;
+
+			EventLogWriter(const EventLogWriter&) = delete;
+			EventLogWriter& operator=(const EventLogWriter&) = delete;
+
+			// Completes the log and moves it into place; returns false if it could not be written
+			bool finish(ParseStatus status);
+			// Drops the partial log, e.g. after a parse that did not complete
+			void discard();
+
+			uint64_t eventsWritten() const { return recordCount; }
+
+			void handle(DemoEventType type, float time, uint32_t frame, const DemoHeader& header) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const std::string& text) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const PlayerState& state) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const EventFrame& eventFrame) override;
+			void handle(DemoEventType type, float time, uint32_t frame, float value) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const ClientData& clientData) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const MoveVars& moveVars) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const UpdateUserInfo& userInfo) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const ServerInfo& serverInfo) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const Angle& angle) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const EntityStatePlayer& entity) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const CustomEntityState& entity) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const ParseDiagnostic& diagnostic) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const WeaponDataUpdate& weaponData) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const TempEntityBatch& tempEntities) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const ServerEventBatch& serverEvents) override;
+
+		private:
+			template<typename Record>
+			void record(DemoEventType type, float time, uint32_t frame, const Record& payload);
+			void record(DemoEventType type, float time, uint32_t frame, const void* payload, size_t size);
+
+			// Offset of text in the string table, added on first use
+			uint32_t intern(const std::string& text);
+
+			std::string path;
+			std::string temporaryPath;
+			std::unique_ptr<BufferedFileWriter> out;
+			DemoEventSink* forward;
+
+			std::string strings;
+			std::unordered_map<std::string, uint32_t> stringIndex;
+			std::vector<uint8_t> recordBuffer;  // reused for records assembled from several parts
+			uint64_t recordCount = 0;
+			uint64_t bytesWritten = 0;
+			bool done = false;
+	};
+
+	// A saved event log, mapped read-only
+	class EventLog
+	{
+		public:
+			explicit EventLog(const std::string& path);
+
+			// False when the file is missing, truncated, has a corrupt record, or was written by
+			// an incompatible build. Every record is checked here, before any replay.
+			bool isValid() const { return valid; }
+			uint64_t sourceHash() const { return hash; }
+			ParseStatus status() const { return parseStatus; }
+			uint64_t eventCount() const { return recordCount; }
+
+			// Sends every event to sink in recorded order; returns false, before sending
+			// anything, when the log is not valid
+			bool replay(DemoEventSink& sink) const;
+
+		private:
+			// Walks the records, sending each to sink; false on the first corrupt one
+			bool decode(DemoEventSink& sink) const;
+
+			MappedFileByteSource file;
+			const uint8_t* records = nullptr;
+			const uint8_t* recordsEnd = nullptr;
+			const char* strings = nullptr;
+			uint64_t stringsSize = 0;
+			uint64_t recordCount = 0;
+			uint64_t hash = 0;
+			ParseStatus parseStatus = ParseStatus::Completed;
+			bool valid = false;
+	};
+
+	// Where ParseWithEventLog keeps the log of a demo: next to it, as <demo>.evlog
+	std::string EventLogPath(const std::string& demoPath);
+
+	// Replays the demo's event log when its hash matches the demo contents. Otherwise (or when
+	// the log is corrupt) deletes the log, parses the demo and, if the parse completes, saves the log for the next call. Events go to
+	// sink, or to the global callbacks when sink is nullptr. StopParsing() has no effect on
+	// a replay.
+	ParseStatus ParseWithEventLog(const std::string& demoPath, DemoEventSink* sink = nullptr);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <demoanalyser/ByteSource.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct z_stream_s;
+
+namespace demo_analyser
+{
+	// Inflates a gzip-compressed demo (.dem.gz) on the fly. The decompressed bytes go through the
+	// BufferedByteSource window, so memory stays bounded and nothing is written to disk.
+	// Forward-only: the directory is picked up when the frames end (see OnReadDirectory).
+	class GzipByteSource : public BufferedByteSource
+	{
+		public:
+			explicit GzipByteSource(std::unique_ptr<ByteSource> compressed);
+			~GzipByteSource() override;
+
+			GzipByteSource(const GzipByteSource&) = delete;
+			GzipByteSource& operator=(const GzipByteSource&) = delete;
+
+			// True when the compressed data is corrupt, as opposed to just ending
+			bool hasInflateError() const { return inflateError; }
+
+			// Checks for the gzip magic without consuming anything; the source must be seekable
+			static bool looksCompressed(ByteSource& source);
+
+		protected:
+			size_t fill(uint8_t* dst, size_t size) override;
+
+		private:
+			static constexpr size_t InputChunkSize = 64 * 1024;
+
+			std::unique_ptr<ByteSource> compressed;
+			std::unique_ptr<z_stream_s> zstream;
+			std::vector<uint8_t> input;
+			bool streamEnded = false;
+			bool inputEnded = false;
+			bool inflateError = false;
+	};
+}
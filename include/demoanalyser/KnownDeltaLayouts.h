@@ -0,0 +1,511 @@
+#pragma once
+
+#include <HalfLifeDeltas.h>
+#include <demoanalyser/DeltaParsers.h>
+#include <demoanalyser/DemoStructs.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+// Stock CS 1.6 delta.lst layouts. When a demo announces a structure whose
+// SVC_DELTADESCRIPTION matches one of these exactly, it is decoded by a fully
+// unrolled decoder that writes straight into the output struct instead of
+// going through HalfLifeDelta and the name lookups in DeltaParsers.h.
+
+namespace demo_analyser
+{
+	constexpr uint32_t DT_BYTE           = static_cast<uint32_t>(HalfLifeDeltaStructure::EntryFlags::Byte);
+	constexpr uint32_t DT_SHORT          = static_cast<uint32_t>(HalfLifeDeltaStructure::EntryFlags::Short);
+	constexpr uint32_t DT_FLOAT          = static_cast<uint32_t>(HalfLifeDeltaStructure::EntryFlags::Float);
+	constexpr uint32_t DT_INTEGER        = static_cast<uint32_t>(HalfLifeDeltaStructure::EntryFlags::Integer);
+	constexpr uint32_t DT_ANGLE          = static_cast<uint32_t>(HalfLifeDeltaStructure::EntryFlags::Angle);
+	constexpr uint32_t DT_TIMEWINDOW_8   = static_cast<uint32_t>(HalfLifeDeltaStructure::EntryFlags::TimeWindow8);
+	constexpr uint32_t DT_TIMEWINDOW_BIG = static_cast<uint32_t>(HalfLifeDeltaStructure::EntryFlags::TimeWindowBig);
+	constexpr uint32_t DT_STRING         = static_cast<uint32_t>(HalfLifeDeltaStructure::EntryFlags::String);
+	constexpr uint32_t DT_SIGNED         = static_cast<uint32_t>(HalfLifeDeltaStructure::EntryFlags::Signed);
+
+	// Where a decoded field lands in the output struct
+	enum class DeltaTarget : uint8_t { None, Float, Int, Byte, String };
+
+	struct KnownDeltaField
+	{
+		const char* Name;
+		uint32_t Flags;
+		uint32_t NBits;
+		float Divisor;
+		DeltaTarget Target;
+		size_t Offset;
+		size_t Size;
+	};
+
+	// Output for structures that are decoded only to advance the bit buffer
+	struct NoDeltaTarget {};
+
+	#define DELTA_SKIP(name, flags, bits, divisor) \
+		{ name, flags, bits, divisor, DeltaTarget::None, 0, 0 }
+	#define DELTA_FLOAT(type, member, flags, bits, divisor) \
+		{ #member, flags, bits, divisor, DeltaTarget::Float, offsetof(type, member), sizeof(float) }
+	#define DELTA_INT(type, member, flags, bits, divisor) \
+		{ #member, flags, bits, divisor, DeltaTarget::Int, offsetof(type, member), sizeof(int) }
+	#define DELTA_BYTE(type, member, flags, bits, divisor) \
+		{ #member, flags, bits, divisor, DeltaTarget::Byte, offsetof(type, member), sizeof(uint8_t) }
+	#define DELTA_STRING(type, member, flags, bits, divisor) \
+		{ #member, flags, bits, divisor, DeltaTarget::String, offsetof(type, member), sizeof(type::member) }
+
+	template <size_t N>
+	constexpr uint64_t knownDeltaFingerprint(const KnownDeltaField (&fields)[N])
+	{
+		uint64_t hash = DeltaFingerprintBasis;
+		for (size_t i = 0; i < N; ++i)
+			hash = deltaFingerprintEntry(hash, fields[i].Name, fields[i].Flags, fields[i].NBits, fields[i].Divisor);
+		return hash;
+	}
+
+	struct EntityStatePlayerLayout
+	{
+		using Target = EntityStatePlayer;
+		static constexpr const char* Name = "entity_state_player_t";
+
+		static constexpr KnownDeltaField Fields[] = {
+			DELTA_FLOAT(EntityStatePlayer, animtime,        DT_TIMEWINDOW_8,        8, 1.0f),
+			DELTA_FLOAT(EntityStatePlayer, frame,           DT_FLOAT,               8, 1.0f),
+			DELTA_FLOAT(EntityStatePlayer, origin[0],       DT_SIGNED | DT_FLOAT,  24, 8.0f),
+			DELTA_FLOAT(EntityStatePlayer, angles[0],       DT_ANGLE,              16, 1.0f),
+			DELTA_FLOAT(EntityStatePlayer, angles[1],       DT_ANGLE,              16, 1.0f),
+			DELTA_FLOAT(EntityStatePlayer, origin[1],       DT_SIGNED | DT_FLOAT,  24, 8.0f),
+			DELTA_FLOAT(EntityStatePlayer, origin[2],       DT_SIGNED | DT_FLOAT,  24, 8.0f),
+			DELTA_INT  (EntityStatePlayer, gaitsequence,    DT_INTEGER,             8, 1.0f),
+			DELTA_INT  (EntityStatePlayer, sequence,        DT_INTEGER,             8, 1.0f),
+			DELTA_INT  (EntityStatePlayer, modelindex,      DT_INTEGER,            10, 1.0f),
+			DELTA_INT  (EntityStatePlayer, movetype,        DT_INTEGER,             4, 1.0f),
+			DELTA_INT  (EntityStatePlayer, solid,           DT_SHORT,               3, 1.0f),
+			DELTA_FLOAT(EntityStatePlayer, mins[0],         DT_SIGNED | DT_FLOAT,  16, 1.0f),
+			DELTA_FLOAT(EntityStatePlayer, mins[1],         DT_SIGNED | DT_FLOAT,  16, 1.0f),
+			DELTA_FLOAT(EntityStatePlayer, mins[2],         DT_SIGNED | DT_FLOAT,  16, 1.0f),
+			DELTA_FLOAT(EntityStatePlayer, maxs[0],         DT_SIGNED | DT_FLOAT,  16, 1.0f),
+			DELTA_FLOAT(EntityStatePlayer, maxs[1],         DT_SIGNED | DT_FLOAT,  16, 1.0f),
+			DELTA_FLOAT(EntityStatePlayer, maxs[2],         DT_SIGNED | DT_FLOAT,  16, 1.0f),
+			DELTA_INT  (EntityStatePlayer, weaponmodel,     DT_INTEGER,            10, 1.0f),
+			DELTA_INT  (EntityStatePlayer, team,            DT_INTEGER,             4, 1.0f),
+			DELTA_INT  (EntityStatePlayer, playerclass,     DT_INTEGER,             4, 1.0f),
+			DELTA_INT  (EntityStatePlayer, owner,           DT_INTEGER,             5, 1.0f),
+			DELTA_INT  (EntityStatePlayer, effects,         DT_INTEGER,             8, 1.0f),
+			DELTA_FLOAT(EntityStatePlayer, angles[2],       DT_ANGLE,              16, 1.0f),
+			DELTA_SKIP ("colormap",                         DT_INTEGER,            16, 1.0f),
+			DELTA_FLOAT(EntityStatePlayer, framerate,       DT_SIGNED | DT_FLOAT,   8, 16.0f),
+			DELTA_INT  (EntityStatePlayer, skin,            DT_SIGNED | DT_SHORT,   9, 1.0f),
+			DELTA_BYTE (EntityStatePlayer, controller[0],   DT_BYTE,                8, 1.0f),
+			DELTA_BYTE (EntityStatePlayer, controller[1],   DT_BYTE,                8, 1.0f),
+			DELTA_BYTE (EntityStatePlayer, controller[2],   DT_BYTE,                8, 1.0f),
+			DELTA_BYTE (EntityStatePlayer, controller[3],   DT_BYTE,                8, 1.0f),
+			DELTA_BYTE (EntityStatePlayer, blending[0],     DT_BYTE,                8, 1.0f),
+			DELTA_BYTE (EntityStatePlayer, blending[1],     DT_BYTE,                8, 1.0f),
+			DELTA_INT  (EntityStatePlayer, body,            DT_INTEGER,             8, 1.0f),
+			DELTA_INT  (EntityStatePlayer, rendermode,      DT_INTEGER,             8, 1.0f),
+			DELTA_INT  (EntityStatePlayer, renderamt,       DT_INTEGER,             8, 1.0f),
+			DELTA_INT  (EntityStatePlayer, renderfx,        DT_INTEGER,             8, 1.0f),
+			DELTA_FLOAT(EntityStatePlayer, scale,           DT_FLOAT,              16, 256.0f),
+			DELTA_BYTE (EntityStatePlayer, rendercolor.r,   DT_BYTE,                8, 1.0f),
+			DELTA_BYTE (EntityStatePlayer, rendercolor.g,   DT_BYTE,                8, 1.0f),
+			DELTA_BYTE (EntityStatePlayer, rendercolor.b,   DT_BYTE,                8, 1.0f),
+			DELTA_FLOAT(EntityStatePlayer, friction,        DT_SIGNED | DT_FLOAT,  10, 1.0f),
+			DELTA_INT  (EntityStatePlayer, usehull,         DT_INTEGER,             1, 1.0f),
+			DELTA_FLOAT(EntityStatePlayer, gravity,         DT_SIGNED | DT_FLOAT,  16, 32.0f),
+			DELTA_INT  (EntityStatePlayer, aiment,          DT_INTEGER,            11, 1.0f),
+			DELTA_FLOAT(EntityStatePlayer, basevelocity[0], DT_SIGNED | DT_FLOAT,  16, 8.0f),
+			DELTA_FLOAT(EntityStatePlayer, basevelocity[1], DT_SIGNED | DT_FLOAT,  16, 8.0f),
+			DELTA_FLOAT(EntityStatePlayer, basevelocity[2], DT_SIGNED | DT_FLOAT,  16, 8.0f),
+			DELTA_INT  (EntityStatePlayer, spectator,       DT_INTEGER,             1, 1.0f),
+		};
+
+		static constexpr uint64_t Fingerprint = knownDeltaFingerprint(Fields);
+
+		static Target fromDelta(const HalfLifeDelta& delta) { return toEntityStatePlayer(delta); }
+	};
+
+	struct EntityStateLayout
+	{
+		using Target = NoDeltaTarget;
+		static constexpr const char* Name = "entity_state_t";
+
+		static constexpr KnownDeltaField Fields[] = {
+			DELTA_SKIP("animtime",        DT_TIMEWINDOW_8,        8, 1.0f),
+			DELTA_SKIP("frame",           DT_FLOAT,               8, 1.0f),
+			DELTA_SKIP("origin[0]",       DT_SIGNED | DT_FLOAT,  24, 8.0f),
+			DELTA_SKIP("angles[0]",       DT_ANGLE,              16, 1.0f),
+			DELTA_SKIP("angles[1]",       DT_ANGLE,              16, 1.0f),
+			DELTA_SKIP("origin[1]",       DT_SIGNED | DT_FLOAT,  24, 8.0f),
+			DELTA_SKIP("origin[2]",       DT_SIGNED | DT_FLOAT,  24, 8.0f),
+			DELTA_SKIP("sequence",        DT_INTEGER,             8, 1.0f),
+			DELTA_SKIP("modelindex",      DT_INTEGER,            10, 1.0f),
+			DELTA_SKIP("movetype",        DT_INTEGER,             4, 1.0f),
+			DELTA_SKIP("solid",           DT_SHORT,               3, 1.0f),
+			DELTA_SKIP("mins[0]",         DT_SIGNED | DT_FLOAT,  16, 1.0f),
+			DELTA_SKIP("mins[1]",         DT_SIGNED | DT_FLOAT,  16, 1.0f),
+			DELTA_SKIP("mins[2]",         DT_SIGNED | DT_FLOAT,  16, 1.0f),
+			DELTA_SKIP("maxs[0]",         DT_SIGNED | DT_FLOAT,  16, 1.0f),
+			DELTA_SKIP("maxs[1]",         DT_SIGNED | DT_FLOAT,  16, 1.0f),
+			DELTA_SKIP("maxs[2]",         DT_SIGNED | DT_FLOAT,  16, 1.0f),
+			DELTA_SKIP("endpos[0]",       DT_SIGNED | DT_FLOAT,  13, 1.0f),
+			DELTA_SKIP("endpos[1]",       DT_SIGNED | DT_FLOAT,  13, 1.0f),
+			DELTA_SKIP("endpos[2]",       DT_SIGNED | DT_FLOAT,  13, 1.0f),
+			DELTA_SKIP("startpos[0]",     DT_SIGNED | DT_FLOAT,  13, 1.0f),
+			DELTA_SKIP("startpos[1]",     DT_SIGNED | DT_FLOAT,  13, 1.0f),
+			DELTA_SKIP("startpos[2]",     DT_SIGNED | DT_FLOAT,  13, 1.0f),
+			DELTA_SKIP("impacttime",      DT_TIMEWINDOW_BIG,     32, 100.0f),
+			DELTA_SKIP("starttime",       DT_TIMEWINDOW_BIG,     32, 100.0f),
+			DELTA_SKIP("weaponmodel",     DT_INTEGER,            10, 1.0f),
+			DELTA_SKIP("owner",           DT_INTEGER,             5, 1.0f),
+			DELTA_SKIP("effects",         DT_INTEGER,             8, 1.0f),
+			DELTA_SKIP("eflags",          DT_INTEGER,             1, 1.0f),
+			DELTA_SKIP("angles[2]",       DT_ANGLE,              16, 1.0f),
+			DELTA_SKIP("colormap",        DT_INTEGER,            16, 1.0f),
+			DELTA_SKIP("framerate",       DT_SIGNED | DT_FLOAT,   8, 16.0f),
+			DELTA_SKIP("skin",            DT_SIGNED | DT_SHORT,   9, 1.0f),
+			DELTA_SKIP("controller[0]",   DT_BYTE,                8, 1.0f),
+			DELTA_SKIP("controller[1]",   DT_BYTE,                8, 1.0f),
+			DELTA_SKIP("controller[2]",   DT_BYTE,                8, 1.0f),
+			DELTA_SKIP("controller[3]",   DT_BYTE,                8, 1.0f),
+			DELTA_SKIP("blending[0]",     DT_BYTE,                8, 1.0f),
+			DELTA_SKIP("blending[1]",     DT_BYTE,                8, 1.0f),
+			DELTA_SKIP("body",            DT_INTEGER,             8, 1.0f),
+			DELTA_SKIP("rendermode",      DT_INTEGER,             8, 1.0f),
+			DELTA_SKIP("renderamt",       DT_INTEGER,             8, 1.0f),
+			DELTA_SKIP("renderfx",        DT_INTEGER,             8, 1.0f),
+			DELTA_SKIP("scale",           DT_FLOAT,              16, 256.0f),
+			DELTA_SKIP("rendercolor.r",   DT_BYTE,                8, 1.0f),
+			DELTA_SKIP("rendercolor.g",   DT_BYTE,                8, 1.0f),
+			DELTA_SKIP("rendercolor.b",   DT_BYTE,                8, 1.0f),
+			DELTA_SKIP("aiment",          DT_INTEGER,            11, 1.0f),
+			DELTA_SKIP("basevelocity[0]", DT_SIGNED | DT_FLOAT,  16, 8.0f),
+			DELTA_SKIP("basevelocity[1]", DT_SIGNED | DT_FLOAT,  16, 8.0f),
+			DELTA_SKIP("basevelocity[2]", DT_SIGNED | DT_FLOAT,  16, 8.0f),
+		};
+
+		static constexpr uint64_t Fingerprint = knownDeltaFingerprint(Fields);
+
+		static Target fromDelta(const HalfLifeDelta&) { return {}; }
+	};
+
+	struct CustomEntityStateLayout
+	{
+		using Target = CustomEntityState;
+		static constexpr const char* Name = "custom_entity_state_t";
+
+		static constexpr KnownDeltaField Fields[] = {
+			DELTA_INT  (CustomEntityState, rendermode,    DT_INTEGER,            8, 1.0f),
+			DELTA_FLOAT(CustomEntityState, origin[0],     DT_SIGNED | DT_FLOAT, 17, 8.0f),
+			DELTA_FLOAT(CustomEntityState, origin[1],     DT_SIGNED | DT_FLOAT, 17, 8.0f),
+			DELTA_FLOAT(CustomEntityState, origin[2],     DT_SIGNED | DT_FLOAT, 17, 8.0f),
+			DELTA_FLOAT(CustomEntityState, angles[0],     DT_SIGNED | DT_FLOAT, 17, 8.0f),
+			DELTA_FLOAT(CustomEntityState, angles[1],     DT_SIGNED | DT_FLOAT, 17, 8.0f),
+			DELTA_FLOAT(CustomEntityState, angles[2],     DT_SIGNED | DT_FLOAT, 17, 8.0f),
+			DELTA_INT  (CustomEntityState, sequence,      DT_INTEGER,           16, 1.0f),
+			DELTA_INT  (CustomEntityState, skin,          DT_INTEGER,           16, 1.0f),
+			DELTA_INT  (CustomEntityState, modelindex,    DT_INTEGER,           16, 1.0f),
+			DELTA_FLOAT(CustomEntityState, scale,         DT_FLOAT,              8, 1.0f),
+			DELTA_INT  (CustomEntityState, body,          DT_INTEGER,            8, 1.0f),
+			DELTA_BYTE (CustomEntityState, rendercolor.r, DT_BYTE,               8, 1.0f),
+			DELTA_BYTE (CustomEntityState, rendercolor.g, DT_BYTE,               8, 1.0f),
+			DELTA_BYTE (CustomEntityState, rendercolor.b, DT_BYTE,               8, 1.0f),
+			DELTA_INT  (CustomEntityState, renderfx,      DT_INTEGER,            8, 1.0f),
+			DELTA_INT  (CustomEntityState, renderamt,     DT_INTEGER,            8, 1.0f),
+			DELTA_FLOAT(CustomEntityState, frame,         DT_FLOAT,              8, 1.0f),
+			DELTA_FLOAT(CustomEntityState, animtime,      DT_FLOAT,              8, 1.0f),
+		};
+
+		static constexpr uint64_t Fingerprint = knownDeltaFingerprint(Fields);
+
+		static Target fromDelta(const HalfLifeDelta& delta) { return toCustomEntityState(delta); }
+	};
+
+	struct ClientDataLayout
+	{
+		using Target = ClientData;
+		static constexpr const char* Name = "clientdata_t";
+
+		static constexpr KnownDeltaField Fields[] = {
+			DELTA_INT  (ClientData, flTimeStepSound, DT_INTEGER,            10, 1.0f),
+			DELTA_FLOAT(ClientData, origin[0],       DT_SIGNED | DT_FLOAT,  21, 128.0f),
+			DELTA_FLOAT(ClientData, origin[1],       DT_SIGNED | DT_FLOAT,  21, 128.0f),
+			DELTA_FLOAT(ClientData, velocity[0],     DT_SIGNED | DT_FLOAT,  16, 8.0f),
+			DELTA_FLOAT(ClientData, velocity[1],     DT_SIGNED | DT_FLOAT,  16, 8.0f),
+			DELTA_FLOAT(ClientData, m_flNextAttack,  DT_SIGNED | DT_FLOAT,  22, 1000.0f),
+			DELTA_FLOAT(ClientData, origin[2],       DT_SIGNED | DT_FLOAT,  21, 128.0f),
+			DELTA_FLOAT(ClientData, velocity[2],     DT_SIGNED | DT_FLOAT,  16, 8.0f),
+			DELTA_INT  (ClientData, ammo_nails,      DT_INTEGER,            10, 1.0f),
+			DELTA_INT  (ClientData, ammo_shells,     DT_INTEGER,            10, 1.0f),
+			DELTA_INT  (ClientData, ammo_cells,      DT_INTEGER,            10, 1.0f),
+			DELTA_INT  (ClientData, ammo_rockets,    DT_INTEGER,            10, 1.0f),
+			DELTA_INT  (ClientData, m_iId,           DT_INTEGER,             5, 1.0f),
+			DELTA_FLOAT(ClientData, punchangle[2],   DT_SIGNED | DT_FLOAT,  16, 8.0f),
+			DELTA_INT  (ClientData, flags,           DT_INTEGER,            32, 1.0f),
+			DELTA_INT  (ClientData, weaponanim,      DT_INTEGER,             8, 1.0f),
+			DELTA_FLOAT(ClientData, health,          DT_SIGNED | DT_FLOAT,  10, 1.0f),
+			DELTA_FLOAT(ClientData, maxspeed,        DT_FLOAT,              16, 10.0f),
+			DELTA_INT  (ClientData, flDuckTime,      DT_INTEGER,            10, 1.0f),
+			DELTA_FLOAT(ClientData, view_ofs[2],     DT_SIGNED | DT_FLOAT,  10, 4.0f),
+			DELTA_FLOAT(ClientData, punchangle[0],   DT_SIGNED | DT_FLOAT,  16, 8.0f),
+			DELTA_FLOAT(ClientData, punchangle[1],   DT_SIGNED | DT_FLOAT,  16, 8.0f),
+			DELTA_INT  (ClientData, viewmodel,       DT_INTEGER,            10, 1.0f),
+			DELTA_FLOAT(ClientData, view_ofs[0],     DT_SIGNED | DT_FLOAT,  10, 4.0f),
+			DELTA_FLOAT(ClientData, view_ofs[1],     DT_SIGNED | DT_FLOAT,  10, 4.0f),
+			DELTA_INT  (ClientData, waterjumptime,   DT_INTEGER,            15, 1.0f),
+			DELTA_INT  (ClientData, flSwimTime,      DT_INTEGER,            10, 1.0f),
+			DELTA_INT  (ClientData, waterlevel,      DT_INTEGER,             2, 1.0f),
+			DELTA_INT  (ClientData, watertype,       DT_SIGNED | DT_INTEGER, 4, 1.0f),
+			DELTA_INT  (ClientData, bInDuck,         DT_INTEGER,             1, 1.0f),
+			DELTA_INT  (ClientData, weapons,         DT_INTEGER,            32, 1.0f),
+			DELTA_FLOAT(ClientData, fov,             DT_FLOAT,               8, 1.0f),
+			DELTA_INT  (ClientData, deadflag,        DT_INTEGER,             3, 1.0f),
+			DELTA_INT  (ClientData, tfstate,         DT_INTEGER,             4, 1.0f),
+			DELTA_INT  (ClientData, pushmsec,        DT_INTEGER,            11, 1.0f),
+			DELTA_STRING(ClientData, physinfo,       DT_STRING,              1, 1.0f),
+			DELTA_INT  (ClientData, iuser1,          DT_SIGNED | DT_INTEGER, 32, 1.0f),
+			DELTA_INT  (ClientData, iuser2,          DT_SIGNED | DT_INTEGER, 32, 1.0f),
+			DELTA_INT  (ClientData, iuser3,          DT_SIGNED | DT_INTEGER, 32, 1.0f),
+			DELTA_INT  (ClientData, iuser4,          DT_SIGNED | DT_INTEGER, 32, 1.0f),
+			DELTA_FLOAT(ClientData, fuser1,          DT_SIGNED | DT_FLOAT,  22, 128.0f),
+			DELTA_FLOAT(ClientData, fuser2,          DT_SIGNED | DT_FLOAT,  22, 128.0f),
+			DELTA_FLOAT(ClientData, fuser3,          DT_SIGNED | DT_FLOAT,  22, 128.0f),
+			DELTA_FLOAT(ClientData, fuser4,          DT_SIGNED | DT_FLOAT,  22, 128.0f),
+			DELTA_FLOAT(ClientData, vuser1[0],       DT_SIGNED | DT_FLOAT,  16, 8.0f),
+			DELTA_FLOAT(ClientData, vuser1[1],       DT_SIGNED | DT_FLOAT,  16, 8.0f),
+			DELTA_FLOAT(ClientData, vuser1[2],       DT_SIGNED | DT_FLOAT,  16, 8.0f),
+			DELTA_FLOAT(ClientData, vuser2[0],       DT_SIGNED | DT_FLOAT,  16, 8.0f),
+			DELTA_FLOAT(ClientData, vuser2[1],       DT_SIGNED | DT_FLOAT,  16, 8.0f),
+			DELTA_FLOAT(ClientData, vuser2[2],       DT_SIGNED | DT_FLOAT,  16, 8.0f),
+			DELTA_FLOAT(ClientData, vuser3[0],       DT_SIGNED | DT_FLOAT,  16, 8.0f),
+			DELTA_FLOAT(ClientData, vuser3[1],       DT_SIGNED | DT_FLOAT,  16, 8.0f),
+			DELTA_FLOAT(ClientData, vuser3[2],       DT_SIGNED | DT_FLOAT,  16, 8.0f),
+			DELTA_FLOAT(ClientData, vuser4[0],       DT_SIGNED | DT_FLOAT,  16, 8.0f),
+			DELTA_FLOAT(ClientData, vuser4[1],       DT_SIGNED | DT_FLOAT,  16, 8.0f),
+			DELTA_FLOAT(ClientData, vuser4[2],       DT_SIGNED | DT_FLOAT,  16, 8.0f),
+		};
+
+		static constexpr uint64_t Fingerprint = knownDeltaFingerprint(Fields);
+
+		static Target fromDelta(const HalfLifeDelta& delta) { return toClientData(delta); }
+	};
+
+	struct WeaponDataLayout
+	{
+		using Target = WeaponData;
+		static constexpr const char* Name = "weapon_data_t";
+
+		static constexpr KnownDeltaField Fields[] = {
+			DELTA_INT  (WeaponData, m_iId,                   DT_INTEGER,             5, 1.0f),
+			DELTA_INT  (WeaponData, m_iClip,                 DT_SIGNED | DT_INTEGER, 10, 1.0f),
+			DELTA_FLOAT(WeaponData, m_flNextPrimaryAttack,   DT_SIGNED | DT_FLOAT,  22, 1000.0f),
+			DELTA_FLOAT(WeaponData, m_flNextSecondaryAttack, DT_SIGNED | DT_FLOAT,  22, 1000.0f),
+			DELTA_FLOAT(WeaponData, m_flTimeWeaponIdle,      DT_SIGNED | DT_FLOAT,  22, 1000.0f),
+			DELTA_INT  (WeaponData, m_fInReload,             DT_INTEGER,             1, 1.0f),
+			DELTA_INT  (WeaponData, m_fInSpecialReload,      DT_INTEGER,             2, 1.0f),
+			DELTA_FLOAT(WeaponData, m_flNextReload,          DT_SIGNED | DT_FLOAT,  22, 1000.0f),
+			DELTA_FLOAT(WeaponData, m_flPumpTime,            DT_SIGNED | DT_FLOAT,  22, 1000.0f),
+			DELTA_FLOAT(WeaponData, m_fReloadTime,           DT_SIGNED | DT_FLOAT,  22, 1000.0f),
+			DELTA_FLOAT(WeaponData, m_fAimedDamage,          DT_SIGNED | DT_FLOAT,  22, 1000.0f),
+			DELTA_FLOAT(WeaponData, m_fNextAimBonus,         DT_SIGNED | DT_FLOAT,  22, 1000.0f),
+			DELTA_INT  (WeaponData, m_fInZoom,               DT_INTEGER,             1, 1.0f),
+			DELTA_INT  (WeaponData, m_iWeaponState,          DT_INTEGER,             2, 1.0f),
+			DELTA_INT  (WeaponData, iuser1,                  DT_INTEGER,             2, 1.0f),
+			DELTA_INT  (WeaponData, iuser2,                  DT_INTEGER,             2, 1.0f),
+			DELTA_INT  (WeaponData, iuser3,                  DT_INTEGER,             2, 1.0f),
+			DELTA_FLOAT(WeaponData, fuser1,                  DT_SIGNED | DT_FLOAT,  22, 1000.0f),
+			DELTA_FLOAT(WeaponData, fuser2,                  DT_SIGNED | DT_FLOAT,  22, 1000.0f),
+		};
+
+		static constexpr uint64_t Fingerprint = knownDeltaFingerprint(Fields);
+
+		static Target fromDelta(const HalfLifeDelta& delta) { return toWeaponData(delta); }
+	};
+
+	struct EventLayout
+	{
+		using Target = ServerEventArgs;
+		static constexpr const char* Name = "event_t";
+
+		static constexpr KnownDeltaField Fields[] = {
+			DELTA_INT  (ServerEventArgs, entindex,  DT_INTEGER,             11, 1.0f),
+			DELTA_INT  (ServerEventArgs, bparam1,   DT_INTEGER,              1, 1.0f),
+			DELTA_INT  (ServerEventArgs, bparam2,   DT_INTEGER,              1, 1.0f),
+			DELTA_FLOAT(ServerEventArgs, origin[0], DT_SIGNED | DT_FLOAT,   26, 8.0f),
+			DELTA_FLOAT(ServerEventArgs, origin[1], DT_SIGNED | DT_FLOAT,   26, 8.0f),
+			DELTA_FLOAT(ServerEventArgs, origin[2], DT_SIGNED | DT_FLOAT,   26, 8.0f),
+			DELTA_FLOAT(ServerEventArgs, fparam1,   DT_SIGNED | DT_FLOAT,   20, 100.0f),
+			DELTA_FLOAT(ServerEventArgs, fparam2,   DT_SIGNED | DT_FLOAT,   20, 100.0f),
+			DELTA_INT  (ServerEventArgs, iparam1,   DT_SIGNED | DT_INTEGER, 16, 1.0f),
+			DELTA_INT  (ServerEventArgs, iparam2,   DT_SIGNED | DT_INTEGER, 16, 1.0f),
+			DELTA_FLOAT(ServerEventArgs, angles[0], DT_ANGLE,               16, 1.0f),
+			DELTA_FLOAT(ServerEventArgs, angles[1], DT_ANGLE,               16, 1.0f),
+			DELTA_FLOAT(ServerEventArgs, angles[2], DT_ANGLE,               16, 1.0f),
+			DELTA_INT  (ServerEventArgs, ducking,   DT_INTEGER,              1, 1.0f),
+		};
+
+		static constexpr uint64_t Fingerprint = knownDeltaFingerprint(Fields);
+
+		static Target fromDelta(const HalfLifeDelta& delta) { return toServerEventArgs(delta); }
+	};
+
+	// The parser's own description of SVC_DELTADESCRIPTION entries, see the DemoParser constructor
+	struct DeltaDescriptionLayout
+	{
+		using Target = NoDeltaTarget;
+		static constexpr const char* Name = "delta_description_t";
+
+		static constexpr KnownDeltaField Fields[] = {
+			DELTA_SKIP("flags",         DT_INTEGER, 32, 1.0f),
+			DELTA_SKIP("name",          DT_STRING,   8, 1.0f),
+			DELTA_SKIP("offset",        DT_INTEGER, 16, 1.0f),
+			DELTA_SKIP("size",          DT_INTEGER,  8, 1.0f),
+			DELTA_SKIP("nBits",         DT_INTEGER,  8, 1.0f),
+			DELTA_SKIP("divisor",       DT_FLOAT,   32, 4000.0f),
+			DELTA_SKIP("preMultiplier", DT_FLOAT,   32, 4000.0f),
+		};
+
+		static constexpr uint64_t Fingerprint = knownDeltaFingerprint(Fields);
+
+		static Target fromDelta(const HalfLifeDelta&) { return {}; }
+	};
+
+	#undef DELTA_SKIP
+	#undef DELTA_FLOAT
+	#undef DELTA_INT
+	#undef DELTA_BYTE
+	#undef DELTA_STRING
+
+	// Full comparison behind the fingerprint, so a hash collision can never pick the wrong decoder
+	template <typename Layout>
+	bool matchesKnownLayout(const HalfLifeDeltaStructure& structure)
+	{
+		constexpr size_t nFields = std::size(Layout::Fields);
+
+		if (structure.getName() != Layout::Name || structure.getFingerprint() != Layout::Fingerprint)
+			return false;
+
+		const auto& entries = structure.getEntries();
+		if (entries.size() != nFields)
+			return false;
+
+		for (size_t i = 0; i < nFields; ++i)
+		{
+			const KnownDeltaField& field = Layout::Fields[i];
+			const HalfLifeDeltaStructure::Entry& entry = entries[i];
+
+			if (entry.name != field.Name || static_cast<uint32_t>(entry.flags) != field.Flags ||
+				entry.nBits != field.NBits || entry.divisor != field.Divisor)
+				return false;
+		}
+
+		return true;
+	}
+
+	// One field of a known layout. Mirrors HalfLifeDeltaStructure::parseEntry and the
+	// conversions in DeltaParsers.h, with every branch resolved at compile time.
+	template <typename Layout, size_t I, typename Target>
+	inline void decodeKnownField(BitBuffer& bitBuffer, Target& out)
+	{
+		constexpr const KnownDeltaField& field = Layout::Fields[I];
+		constexpr bool isSigned = (field.Flags & DT_SIGNED) != 0;
+
+		auto store = [&](auto value) {
+			if constexpr (field.Target == DeltaTarget::Float) {
+				float v = static_cast<float>(value);
+				std::memcpy(reinterpret_cast<char*>(&out) + field.Offset, &v, sizeof(v));
+			} else if constexpr (field.Target == DeltaTarget::Int) {
+				int v = static_cast<int>(value);
+				std::memcpy(reinterpret_cast<char*>(&out) + field.Offset, &v, sizeof(v));
+			} else if constexpr (field.Target == DeltaTarget::Byte) {
+				uint8_t v = static_cast<uint8_t>(static_cast<int>(value));
+				std::memcpy(reinterpret_cast<char*>(&out) + field.Offset, &v, sizeof(v));
+			}
+		};
+
+		auto readInt = [&]() -> int32_t {
+			bool negative = bitBuffer.readBoolean();
+			int32_t val = static_cast<int32_t>(bitBuffer.readUnsignedBits(field.NBits - 1));
+			val = static_cast<int32_t>(val / field.Divisor);
+			return negative ? -val : val;
+		};
+
+		auto readUnsignedInt = [&]() -> uint32_t {
+			return bitBuffer.readUnsignedBits(field.NBits) / static_cast<uint32_t>(field.Divisor);
+		};
+
+		if constexpr (field.Flags & DT_BYTE) {
+			if constexpr (isSigned) store(static_cast<int8_t>(readInt()));
+			else                    store(static_cast<uint8_t>(readUnsignedInt()));
+		}
+		else if constexpr (field.Flags & DT_SHORT) {
+			if constexpr (isSigned) store(static_cast<int16_t>(readInt()));
+			else                    store(static_cast<uint16_t>(readUnsignedInt()));
+		}
+		else if constexpr (field.Flags & DT_INTEGER) {
+			if constexpr (isSigned) store(readInt());
+			else                    store(readUnsignedInt());
+		}
+		else if constexpr (field.Flags & (DT_FLOAT | DT_TIMEWINDOW_8 | DT_TIMEWINDOW_BIG)) {
+			bool negative = false;
+			int bitsToRead = static_cast<int>(field.NBits);
+
+			if constexpr (isSigned) {
+				negative = bitBuffer.readBoolean();
+				bitsToRead--;
+			}
+
+			float value = static_cast<float>(bitBuffer.readUnsignedBits(bitsToRead)) / field.Divisor;
+			store(negative ? -value : value);
+		}
+		else if constexpr (field.Flags & DT_ANGLE) {
+			store(static_cast<float>(bitBuffer.readUnsignedBits(static_cast<int>(field.NBits)) * (360.0f / static_cast<float>(1 << field.NBits))));
+		}
+		else if constexpr (field.Flags & DT_STRING) {
+			if constexpr (field.Target == DeltaTarget::String) {
+				std::string value = bitBuffer.readString();
+				char* dst = reinterpret_cast<char*>(&out) + field.Offset;
+				std::strncpy(dst, value.c_str(), field.Size);
+				dst[field.Size - 1] = '\0';
+			} else {
+				bitBuffer.skipString();
+			}
+		}
+		else {
+			static_assert(field.Flags & DT_STRING, "Unknown delta entry type in known layout");
+		}
+	}
+
+	template <typename Layout, typename Target, size_t... I>
+	inline void decodeKnownFields(BitBuffer& bitBuffer, uint64_t bitmask, Target& out, std::index_sequence<I...>)
+	{
+		((bitmask & (uint64_t{1} << I) ? decodeKnownField<Layout, I>(bitBuffer, out) : void()), ...);
+	}
+
+	// Reads one delta of a structure known to match Layout, field by field in wire order
+	template <typename Layout>
+	inline void decodeKnownDelta(BitBuffer& bitBuffer, typename Layout::Target& out)
+	{
+		constexpr size_t nFields = std::size(Layout::Fields);
+		static_assert(nFields <= 56, "Delta bitmask holds at most 56 fields");
+
+		uint64_t bitmask = HalfLifeDeltaStructure::readBitmask(bitBuffer);
+		decodeKnownFields<Layout>(bitBuffer, bitmask, out, std::make_index_sequence<nFields>{});
+	}
+
+	// Copies the fields a generically decoded delta actually sent from decoded into out,
+	// leaving the rest of out as it was, the same as decodeKnownDelta does
+	template <typename Layout>
+	inline void mergeDeltaFields(const HalfLifeDelta& delta, const typename Layout::Target& decoded, typename Layout::Target& out)
+	{
+		for (const KnownDeltaField& field : Layout::Fields) {
+			if (field.Target == DeltaTarget::None || !delta.isEntryPresent(field.Name))
+				continue;
+
+			std::memcpy(reinterpret_cast<uint8_t*>(&out) + field.Offset,
+				reinterpret_cast<const uint8_t*>(&decoded) + field.Offset, field.Size);
+		}
+	}
+}
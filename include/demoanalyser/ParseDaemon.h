@@ -0,0 +1,114 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace demo_analyser
+{
+	struct ParseDaemonOptions
+	{
+		std::string SocketPath;
+		unsigned Workers = 0;        // 0 = hardware concurrency
+		size_t CacheEntries = 256;   // results kept by the LRU cache
+	};
+
+	// Long-running parse server on a Unix domain socket. Jobs run on a fixed pool of worker
+	// threads, so delta structures (DeltaStructureCache) and other process-wide state stay
+	// warm across jobs, and results are kept in an LRU cache keyed by the demo's content hash
+	// and the job parameters. A repeated job is answered from the cache without touching
+	// the demo beyond a stat, or a hash when the file changed.
+	//
+	// Protocol: one request line per connection, the verb then tab-separated key=value fields.
+	// The daemon answers and closes the connection.
+	//
+	//     PARSE  path=<demo> [start=<s>] [end=<s>] [outputs=summary,ndjson,csv,arrow,trajectory] [prefix=<p>]
+	//     STATS
+	//
+	// Answers start with "OK" or "ERROR <reason>", followed by key=value lines. PARSE reports
+	// cached=0|1, the status, the content hash, a summary (map, last frame and time, a count
+	// per event type) and a file= line per file written. Export outputs are written to
+	// <prefix><table>.<ext>, the prefix defaulting to the demo path without extension plus "_".
+	class ParseDaemon
+	{
+		public:
+			explicit ParseDaemon(ParseDaemonOptions options);
+			~ParseDaemon();
+
+			ParseDaemon(const ParseDaemon&) = delete;
+			ParseDaemon& operator=(const ParseDaemon&) = delete;
+
+			// Binds the socket and starts the workers; false, with error() set, on failure
+			bool start();
+
+			// Stops accepting, lets running jobs finish and removes the socket file
+			void stop();
+
+			const std::string& error() const { return lastError; }
+
+			// Answers one request line, as for a connection
+			std::string handleRequest(const std::string& line);
+
+		private:
+			struct CachedResult
+			{
+				std::string Key;
+				std::string Response;
+				std::vector<std::string> Files;  // the hit is dropped if one of them is gone
+			};
+
+			struct FileIdentity
+			{
+				int64_t Size = 0;
+				int64_t ModifiedNanoseconds = 0;
+				uint64_t Hash = 0;
+			};
+
+			void acceptLoop();
+			void workerLoop();
+			void serve(int connection);
+
+			bool contentHash(const std::string& path, uint64_t& hash);
+			bool findCached(const std::string& key, std::string& response);
+			void storeCached(CachedResult result);
+
+			std::string runParse(const std::unordered_map<std::string, std::string>& fields);
+
+			ParseDaemonOptions options;
+			std::string lastError;
+			int listener = -1;
+			bool running = false;
+
+			std::thread acceptor;
+			std::vector<std::thread> workers;
+
+			std::mutex queueMutex;
+			std::condition_variable queueReady;
+			std::deque<int> connections;
+			bool stopping = false;
+
+			// LRU: most recently used first
+			std::mutex cacheMutex;
+			std::condition_variable jobDone;
+			std::list<CachedResult> cache;
+			std::unordered_map<std::string, std::list<CachedResult>::iterator> cacheIndex;
+			std::set<std::string> inFlight;  // keys being computed, repeats wait for them
+			uint64_t hits = 0;
+			uint64_t misses = 0;
+
+			std::mutex hashMutex;
+			std::unordered_map<std::string, FileIdentity> fileHashes;
+	};
+
+	// Sends one request line to a daemon and returns its whole answer; throws std::runtime_error
+	// when the daemon cannot be reached
+	std::string SendDaemonRequest(const std::string& socketPath, const std::string& request);
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+
+namespace demo_analyser
+{
+	// How a parseDemo call ended
+	enum class ParseStatus : uint8_t {
+		Completed,         // reached the end of the demo (or of the requested time window)
+		Stopped,           // StopParsing() from a callback
+		Cancelled,         // CancellationToken::cancel()
+		DeadlineExceeded,  // CancellationToken deadline passed
+	};
+
+	inline const char* ParseStatusName(ParseStatus status)
+	{
+		switch (status)
+		{
+			case ParseStatus::Completed:        return "Completed";
+			case ParseStatus::Stopped:          return "Stopped";
+			case ParseStatus::Cancelled:        return "Cancelled";
+			case ParseStatus::DeadlineExceeded: return "DeadlineExceeded";
+		}
+		return "Unknown";
+	}
+
+	// Lets another thread stop a parse, or bound it with a deadline. The frame loop checks it
+	// once per frame, so a parse ends within one frame of the request.
+	class CancellationToken
+	{
+		public:
+			using Clock = std::chrono::steady_clock;
+
+			void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+			bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+
+			void setDeadline(Clock::time_point time) { deadline.store(time.time_since_epoch().count(), std::memory_order_relaxed); }
+			void setTimeout(Clock::duration timeout) { setDeadline(Clock::now() + timeout); }
+
+			bool deadlineExceeded() const
+			{
+				auto time = deadline.load(std::memory_order_relaxed);
+				return time != NoDeadline && Clock::now().time_since_epoch().count() >= time;
+			}
+
+		private:
+			static constexpr Clock::rep NoDeadline = std::numeric_limits<Clock::rep>::max();
+
+			std::atomic<bool> cancelled{false};
+			std::atomic<Clock::rep> deadline{NoDeadline};
+	};
+
+	// What a parseDemo call decodes. The default request decodes everything.
+	//
+	// Frames of an unwanted type are skipped by offset without reading their payload.
+	// Unwanted SVC messages inside a game data frame are still walked (they have no length
+	// prefix) but only skipped over, without callbacks.
+	// Game data that later frames depend on is always decoded, silently if unwanted: the
+	// loading segment (delta descriptions, user message registrations, baselines) and the
+	// playback game data frames before StartTime, so the state the parser keeps from earlier
+	// messages is current when the window opens. Other frames outside the time window are
+	// skipped by offset. Parsing ends at the first playback frame past EndTime.
+	struct ParseRequest
+	{
+		float StartTime = -std::numeric_limits<float>::infinity();
+		float EndTime = std::numeric_limits<float>::infinity();
+
+		std::bitset<256> FrameTypes = std::bitset<256>().set();  // by FrameHeader::Type, 0 and 1 are game data
+		std::bitset<256> Messages = std::bitset<256>().set();    // by SVC message id
+
+		const CancellationToken* Cancellation = nullptr;         // not owned, must outlive the parse
+
+		ParseRequest& timeRange(float start, float end)
+		{
+			StartTime = start;
+			EndTime = end;
+			return *this;
+		}
+
+		ParseRequest& onlyFrameTypes(std::initializer_list<uint8_t> types)
+		{
+			FrameTypes.reset();
+			for (uint8_t type : types)
+				FrameTypes.set(type);
+			return *this;
+		}
+
+		ParseRequest& onlyMessages(std::initializer_list<uint8_t> messageIds)
+		{
+			Messages.reset();
+			for (uint8_t id : messageIds)
+				Messages.set(id);
+			return *this;
+		}
+
+		ParseRequest& cancelWith(const CancellationToken& token)
+		{
+			Cancellation = &token;
+			return *this;
+		}
+
+		bool wantsFrame(uint8_t type, float timestamp) const
+		{
+			return FrameTypes.test(type) && timestamp >= StartTime && timestamp <= EndTime;
+		}
+
+		bool wantsMessage(uint8_t messageId) const { return Messages.test(messageId); }
+	};
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace demo_analyser
+{
+	// A player slot as last described by SVC_UPDATEUSERINFO. The userinfo string is tokenized
+	// once per change; keys and values are views into UserInfo, valid until the slot changes.
+	// Copies and moves point their views at their own UserInfo.
+	struct PlayerSlot
+	{
+		PlayerSlot() = default;
+		PlayerSlot(const PlayerSlot& other) { *this = other; }
+		PlayerSlot(PlayerSlot&& other) noexcept { *this = std::move(other); }
+		PlayerSlot& operator=(const PlayerSlot& other);
+		PlayerSlot& operator=(PlayerSlot&& other) noexcept;
+
+		bool Active = false;      // a player holds the slot (an empty userinfo frees it)
+		uint8_t Slot = 0;         // ClientIndex; the player's entity number is Slot + 1
+		uint32_t UserID = 0;
+		uint64_t SteamID = 0;     // from *sid, 0 for bots and servers that do not send it
+		uint8_t CDKeyHash[16] = {};
+
+		std::string UserInfo;     // raw "\key\value..." string
+		std::vector<std::pair<std::string_view, std::string_view>> Fields;
+
+		// common fields, "" when missing
+		std::string_view Name;
+		std::string_view Team;
+		std::string_view Model;
+
+		// Value of key, "" when missing
+		std::string_view get(std::string_view key) const;
+
+		private:
+			// Moves the views from a UserInfo buffer at from to this slot's
+			void rebase(const char* from);
+	};
+
+	// Per-slot player table kept up to date from SVC_UPDATEUSERINFO, with constant-time lookups
+	// by slot, user ID and Steam ID. Updates reuse the slot's buffers: repeated userinfo is not
+	// tokenized again and changed userinfo does not allocate once the buffers have grown.
+	class PlayerTable
+	{
+		public:
+			// Empties the table and sizes it for maxClients slots (a new level)
+			void reset(size_t maxClients);
+
+			const PlayerSlot& update(uint8_t slot, uint32_t userID, const std::string& userInfo, const uint8_t cdKeyHash[16]);
+
+			// nullptr when the slot is free or out of range, or no player has the ID
+			const PlayerSlot* bySlot(size_t slot) const;
+			const PlayerSlot* byUserID(uint32_t userID) const;
+			const PlayerSlot* bySteamID(uint64_t steamID) const;
+
+			// Every slot, free ones included (check Active)
+			const std::vector<PlayerSlot>& slots() const { return table; }
+
+		private:
+			static void tokenize(PlayerSlot& player);
+			void unindex(const PlayerSlot& player);
+
+			std::vector<PlayerSlot> table;
+			std::unordered_map<uint32_t, uint8_t> userIDs;
+			std::unordered_map<uint64_t, uint8_t> steamIDs;
+	};
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <demoanalyser/ByteSource.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace demo_analyser
+{
+	// Reads the wrapped source on a background thread, up to Depth chunks ahead of the parser,
+	// so decoding only waits on bytes it actually needs and not on each read syscall.
+	// Short backward seeks are served from the BufferedByteSource window; anything further
+	// restarts the reader at the new offset (the wrapped source has to be seekable for that).
+	class ReadAheadByteSource : public BufferedByteSource
+	{
+		public:
+			static constexpr size_t DefaultReadAheadChunkSize = 256 * 1024;
+			static constexpr size_t DefaultDepth = 3;
+
+			explicit ReadAheadByteSource(std::unique_ptr<ByteSource> inner,
+				size_t chunkSize = DefaultReadAheadChunkSize, size_t depth = DefaultDepth);
+			~ReadAheadByteSource() override;
+
+			ReadAheadByteSource(const ReadAheadByteSource&) = delete;
+			ReadAheadByteSource& operator=(const ReadAheadByteSource&) = delete;
+
+			int64_t size() const override { return inner->size(); }
+			bool seekable() const override { return inner->seekable(); }
+
+		protected:
+			size_t fill(uint8_t* dst, size_t size) override;
+			bool seekRaw(int64_t offset) override;
+
+		private:
+			struct Chunk
+			{
+				std::vector<uint8_t> Data;
+				size_t Length = 0;
+			};
+
+			void start();
+			void stop();
+			void run();
+
+			std::unique_ptr<ByteSource> inner;
+			size_t chunkSize;
+			size_t depth;
+
+			std::mutex mutex;
+			std::condition_variable chunkReady;
+			std::condition_variable slotFree;
+			std::deque<Chunk> ready;       // filled by the reader, in file order
+			std::vector<Chunk> spare;      // handed back by the parser for reuse
+			size_t inFlight = 0;           // chunks owned by the reader or queued
+			bool finished = false;         // reader hit the end of the wrapped source
+			bool stopping = false;
+
+			Chunk current;                 // chunk being drained by fill()
+			size_t currentOffset = 0;
+
+			std::thread reader;
+	};
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace demo_analyser
+{
+	// resourcetype_t
+	enum class ResourceType : uint8_t {
+		Sound,
+		Skin,
+		Model,        // modelindex / weaponmodel of entity states
+		Decal,
+		Generic,
+		EventScript,  // event index of SVC_EVENT
+		World,
+	};
+
+	constexpr size_t ResourceTypeCount = 7;
+
+	inline const char* ResourceTypeName(ResourceType type)
+	{
+		switch (type)
+		{
+			case ResourceType::Sound:       return "Sound";
+			case ResourceType::Skin:        return "Skin";
+			case ResourceType::Model:       return "Model";
+			case ResourceType::Decal:       return "Decal";
+			case ResourceType::Generic:     return "Generic";
+			case ResourceType::EventScript: return "EventScript";
+			case ResourceType::World:       return "World";
+		}
+		return "Unknown";
+	}
+
+	struct ResourceEntry
+	{
+		std::string_view Name;  // interned, "" for an index the list did not fill
+		uint32_t Size = 0;      // download size in bytes
+		uint8_t Flags = 0;      // RES_FATALIFMISSING (1), RES_WASMISSING (2), RES_CUSTOM (4)
+	};
+
+	// The server's resource list (SVC_RESOURCELIST), kept as one dense array per resource type
+	// indexed by the resource index, so resolving a modelindex or a sound index is an array
+	// access. Names are interned: equal names share one copy.
+	class ResourceTable
+	{
+		public:
+			void clear();
+
+			void add(ResourceType type, uint32_t index, std::string_view name, uint32_t size, uint8_t flags);
+
+			// "" when the index is not in the list
+			std::string_view name(ResourceType type, uint32_t index) const
+			{
+				const std::vector<ResourceEntry>& entries = byType[static_cast<size_t>(type)];
+				return index < entries.size() ? entries[index].Name : std::string_view();
+			}
+
+			std::string_view model(uint32_t index) const { return name(ResourceType::Model, index); }
+			std::string_view sound(uint32_t index) const { return name(ResourceType::Sound, index); }
+			std::string_view eventScript(uint32_t index) const { return name(ResourceType::EventScript, index); }
+
+			// Entries of a type by index, with gaps for indices the list did not fill
+			const std::vector<ResourceEntry>& entries(ResourceType type) const { return byType[static_cast<size_t>(type)]; }
+
+			size_t size() const { return count; }
+
+		private:
+			std::array<std::vector<ResourceEntry>, ResourceTypeCount> byType;
+			std::unordered_set<std::string> names;  // nodes do not move, views into them stay valid
+			size_t count = 0;
+	};
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <demoanalyser/DemoEvent.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace demo_analyser
+{
+	// One event as stored in the ring: a fixed-size record holding the payload struct by value.
+	// Carried: PlayerState, ClientData, EventFrame, TimeTick (float), SetAngle (Angle), packed and
+	// delta-packed entities (EntityStatePlayer, CustomEntityState), ConsoleCommand and MessagePrint
+	// (text, cut at PayloadSize bytes). Events with variable-size payloads (header, directory, move
+	// vars, user info, server info, diagnostics) are not published.
+	struct SharedEventRecord
+	{
+		static constexpr size_t PayloadSize = sizeof(ClientData);
+
+		DemoEventType Type;
+		uint8_t Truncated = 0;  // text longer than PayloadSize
+		uint8_t Reserved[2] = {};
+		uint32_t FrameNumber = 0;
+		float Timestamp = 0.0f;
+		uint32_t TextLength = 0;
+		alignas(8) uint8_t Payload[PayloadSize];
+
+		template<typename T>
+		const T& as() const { return *reinterpret_cast<const T*>(Payload); }
+
+		std::string_view text() const { return std::string_view(reinterpret_cast<const char*>(Payload), TextLength); }
+	};
+
+	struct SharedEventRingHeader;
+	struct SharedEventSlot;
+
+	// Publishes decoded events into a POSIX shared memory ring (shm_open name, e.g. "/match1")
+	// for any number of local consumer processes. Single producer, lock-free: each slot is a
+	// seqlock, so the producer never waits and a consumer that falls a whole ring behind skips
+	// ahead (SharedEventRingReader::dropped) instead of slowing the parse down.
+	//
+	//     SharedEventRingWriter ring("/match1");
+	//     parser.setEventSink(&ring);
+	//     parser.parseDemo();
+	//     ring.finish();
+	//
+	// The shared memory object is removed when the writer is destroyed; readers already attached
+	// keep their mapping and can drain what is left. A name held by another running producer is
+	// not taken over: the writer fails to open (error() "File exists"). A ring left behind by a
+	// producer that exited without cleaning up is replaced.
+	class SharedEventRingWriter : public DemoEventSink
+	{
+		public:
+			static constexpr uint32_t DefaultCapacity = 16384;  // records, rounded up to a power of two
+
+			explicit SharedEventRingWriter(const std::string& name, uint32_t capacity = DefaultCapacity);
+			~SharedEventRingWriter() override;
+
+			SharedEventRingWriter(const SharedEventRingWriter&) = delete;
+			SharedEventRingWriter& operator=(const SharedEventRingWriter&) = delete;
+
+			bool isOpen() const { return header != nullptr; }
+			const std::string& error() const { return lastError; }
+
+			// Marks the stream as ended, readers get Closed once they have caught up
+			void finish();
+
+			uint64_t published() const { return sequence; }
+
+			using DemoEventSink::handle;
+			void handle(DemoEventType type, float time, uint32_t frame, const std::string& text) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const PlayerState& state) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const EventFrame& eventFrame) override;
+			void handle(DemoEventType type, float time, uint32_t frame, float value) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const ClientData& clientData) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const Angle& angle) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const EntityStatePlayer& entity) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const CustomEntityState& entity) override;
+
+		private:
+			template<typename T>
+			void publish(DemoEventType type, float time, uint32_t frame, const T& value);
+			void publish(DemoEventType type, float time, uint32_t frame, const void* data, size_t size, uint32_t textLength, bool truncated);
+
+			std::string name;
+			std::string lastError;
+			SharedEventRingHeader* header = nullptr;
+			SharedEventSlot* slots = nullptr;
+			size_t mappingSize = 0;
+			uint64_t mask = 0;
+			uint64_t sequence = 0;
+	};
+
+	// Attaches to a ring published by a SharedEventRingWriter, possibly in another process, and
+	// reads it at its own pace. Each reader has its own position; readers do not affect each
+	// other or the producer.
+	class SharedEventRingReader
+	{
+		public:
+			enum class ReadResult : uint8_t {
+				Event,   // record was filled
+				Empty,   // caught up with the producer, try again later
+				Closed,  // caught up and the producer finished
+			};
+
+			// Starts at the oldest record still in the ring, or with fromNewest at the records
+			// published from now on
+			explicit SharedEventRingReader(const std::string& name, bool fromNewest = false);
+			~SharedEventRingReader();
+
+			SharedEventRingReader(const SharedEventRingReader&) = delete;
+			SharedEventRingReader& operator=(const SharedEventRingReader&) = delete;
+
+			bool isOpen() const { return header != nullptr; }
+			const std::string& error() const { return lastError; }
+
+			ReadResult read(SharedEventRecord& record);
+
+			// Records overwritten before this reader got to them
+			uint64_t dropped() const { return droppedRecords; }
+
+		private:
+			std::string lastError;
+			const SharedEventRingHeader* header = nullptr;
+			const SharedEventSlot* slots = nullptr;
+			size_t mappingSize = 0;
+			uint64_t mask = 0;
+			uint64_t position = 0;
+			uint64_t droppedRecords = 0;
+	};
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <demoanalyser/ByteSource.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace demo_analyser
+{
+	// Follows a demo that is still being recorded (HLTV). Reads block at the current end of the
+	// file until more bytes land, so the parser waits at a partial frame instead of failing.
+	// Forward-only, which also skips the directory checks the unfinished file cannot pass.
+	//
+	// Reading ends when the demo ends, when stop() is called (from any thread), or when the
+	// file has not grown for idleTimeout.
+	class TailFileByteSource : public BufferedByteSource
+	{
+		public:
+			static constexpr std::chrono::milliseconds DefaultPollInterval{100};
+			static constexpr std::chrono::milliseconds DefaultIdleTimeout{30000};
+
+			explicit TailFileByteSource(const std::string& path,
+				std::chrono::milliseconds idleTimeout = DefaultIdleTimeout,
+				std::chrono::milliseconds pollInterval = DefaultPollInterval);
+			~TailFileByteSource() override;
+
+			TailFileByteSource(const TailFileByteSource&) = delete;
+			TailFileByteSource& operator=(const TailFileByteSource&) = delete;
+
+			bool isOpen() const { return fd >= 0; }
+
+			// Makes a blocked read return, the parser then sees the end of the demo
+			void stop() { stopped = true; }
+
+		protected:
+			size_t fill(uint8_t* dst, size_t size) override;
+
+		private:
+			void waitForData();
+
+			int fd = -1;
+			int notifyFd = -1;
+			std::chrono::milliseconds idleTimeout;
+			std::chrono::milliseconds pollInterval;
+			std::atomic<bool> stopped{false};
+	};
+}
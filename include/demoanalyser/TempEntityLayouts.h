@@ -0,0 +1,139 @@
+#pragma once
+
+#include <demoanalyser/DemoStructs.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// SVC_TEMPENTITY bodies by TE_* type, as read by the engine's CL_ParseTEnt. One table drives
+// both skipping (Size bytes) and decoding into TempEntity records, so a type is described once.
+
+namespace demo_analyser
+{
+	// How the server writes a field: WRITE_BYTE, WRITE_SHORT, WRITE_COORD (short, 1/8 unit),
+	// WRITE_ANGLE (byte, 1/256 turn)
+	enum class TempEntityField : uint8_t { Byte, Short, Coord, Angle };
+
+	// Parts of a message the fixed fields do not cover
+	enum class TempEntityTail : uint8_t {
+		None,
+		BspDecal,     // short model index when the entity index (last field) is not 0
+		TextMessage,  // short fx time when the effect (field 3) is 2, then the text
+	};
+
+	struct TempEntityLayout
+	{
+		const char* Name = nullptr;  // nullptr: not a temp entity, its length is unknown
+		TempEntityTail Tail = TempEntityTail::None;
+		uint8_t FieldCount = 0;
+		uint8_t Size = 0;            // bytes of the fixed fields
+		TempEntityField Fields[MAX_TEMPENTITY_VALUES] = {};
+	};
+
+	// Fields spelled one letter each: c coord, s short, b byte, a angle; spaces group them
+	constexpr TempEntityLayout tempEntity(const char* name, const char* fields, TempEntityTail tail = TempEntityTail::None)
+	{
+		TempEntityLayout layout;
+		layout.Name = name;
+		layout.Tail = tail;
+
+		for (const char* f = fields; *f; ++f) {
+			TempEntityField field = TempEntityField::Byte;
+			switch (*f) {
+				case 'c': field = TempEntityField::Coord; break;
+				case 's': field = TempEntityField::Short; break;
+				case 'b': field = TempEntityField::Byte; break;
+				case 'a': field = TempEntityField::Angle; break;
+				default: continue;
+			}
+			layout.Fields[layout.FieldCount++] = field;
+			layout.Size += field == TempEntityField::Coord || field == TempEntityField::Short ? 2 : 1;
+		}
+		return layout;
+	}
+
+	constexpr std::array<TempEntityLayout, 128> makeTempEntityLayouts()
+	{
+		std::array<TempEntityLayout, 128> t{};
+
+		t[0]   = tempEntity("TE_BEAMPOINTS",         "ccc ccc s bbbbbbbbbb");  // start, end, sprite, frame, rate, life, width, noise, rgb, brightness, speed
+		t[1]   = tempEntity("TE_BEAMENTPOINT",       "s ccc s bbbbbbbbbb");    // start entity, end, sprite, as above
+		t[2]   = tempEntity("TE_GUNSHOT",            "ccc");
+		t[3]   = tempEntity("TE_EXPLOSION",          "ccc s bbb");             // origin, sprite, scale, framerate, flags
+		t[4]   = tempEntity("TE_TAREXPLOSION",       "ccc");
+		t[5]   = tempEntity("TE_SMOKE",              "ccc s bb");              // origin, sprite, scale, framerate
+		t[6]   = tempEntity("TE_TRACER",             "ccc ccc");
+		t[7]   = tempEntity("TE_LIGHTNING",          "ccc ccc bbb s");         // start, end, life, width, amplitude, sprite
+		t[8]   = tempEntity("TE_BEAMENTS",           "ss s bbbbbbbbbb");       // start entity, end entity, sprite, as TE_BEAMPOINTS
+		t[9]   = tempEntity("TE_SPARKS",             "ccc");
+		t[10]  = tempEntity("TE_LAVASPLASH",         "ccc");
+		t[11]  = tempEntity("TE_TELEPORT",           "ccc");
+		t[12]  = tempEntity("TE_EXPLOSION2",         "ccc bb");                // origin, start color, color count
+		t[13]  = tempEntity("TE_BSPDECAL",           "ccc s s", TempEntityTail::BspDecal);  // origin, texture, entity
+		t[14]  = tempEntity("TE_IMPLOSION",          "ccc bbb");               // origin, radius, count, life
+		t[15]  = tempEntity("TE_SPRITETRAIL",        "ccc ccc s bbbbb");       // start, end, sprite, count, life, scale, velocity, randomness
+		t[16]  = tempEntity("TE_BEAM",               "");                      // obsolete, sent without a body
+		t[17]  = tempEntity("TE_SPRITE",             "ccc s bb");              // origin, sprite, scale, brightness
+		t[18]  = tempEntity("TE_BEAMSPRITE",         "ccc ccc s s");           // start, end, beam sprite, end sprite
+		t[19]  = tempEntity("TE_BEAMTORUS",          "ccc ccc s bbbbbbbbbb");  // center, axis, sprite, as TE_BEAMPOINTS
+		t[20]  = tempEntity("TE_BEAMDISK",           "ccc ccc s bbbbbbbbbb");
+		t[21]  = tempEntity("TE_BEAMCYLINDER",       "ccc ccc s bbbbbbbbbb");
+		t[22]  = tempEntity("TE_BEAMFOLLOW",         "s s bb bbbb");           // entity, sprite, life, width, rgb, brightness
+		t[23]  = tempEntity("TE_GLOWSPRITE",         "ccc s bbb");             // origin, model, scale, size, brightness
+		t[24]  = tempEntity("TE_BEAMRING",           "ss s bbbbbbbbbb");       // start entity, end entity, sprite, as TE_BEAMPOINTS
+		t[25]  = tempEntity("TE_STREAK_SPLASH",      "ccc ccc b s s s");       // origin, direction, color, count, speed, random velocity
+		t[26]  = tempEntity("TE_BEAMHOSE",           "");                      // obsolete, sent without a body
+		t[27]  = tempEntity("TE_DLIGHT",             "ccc b bbb bb");          // origin, radius, rgb, life, decay
+		t[28]  = tempEntity("TE_ELIGHT",             "s ccc c bbb b c");       // entity:attachment, origin, radius, rgb, life, decay
+		t[29]  = tempEntity("TE_TEXTMESSAGE",        "b ss b bbbb bbbb s s s", TempEntityTail::TextMessage);  // channel, x, y, effect, color, effect color, fade in, fade out, hold
+		t[30]  = tempEntity("TE_LINE",               "ccc ccc s bbb");         // start, end, life, rgb
+		t[31]  = tempEntity("TE_BOX",                "ccc ccc s bbb");         // mins, maxs, life, rgb
+
+		t[99]  = tempEntity("TE_KILLBEAM",           "s");                     // entity
+		t[100] = tempEntity("TE_LARGEFUNNEL",        "ccc s s");               // origin, sprite, flags
+		t[101] = tempEntity("TE_BLOODSTREAM",        "ccc ccc bb");            // origin, direction, color, speed
+		t[102] = tempEntity("TE_SHOWLINE",           "ccc ccc");
+		t[103] = tempEntity("TE_BLOOD",              "ccc ccc bb");            // origin, direction, color, speed
+		t[104] = tempEntity("TE_DECAL",              "ccc b s");               // origin, texture, entity
+		t[105] = tempEntity("TE_FIZZ",               "s s b");                 // entity, sprite, density
+		t[106] = tempEntity("TE_MODEL",              "ccc ccc a s bb");        // origin, velocity, yaw, model, bounce sound, life
+		t[107] = tempEntity("TE_EXPLODEMODEL",       "ccc c s s b");           // origin, velocity, model, count, life
+		t[108] = tempEntity("TE_BREAKMODEL",         "ccc ccc ccc b s bbb");   // origin, size, velocity, random velocity, model, count, life, flags
+		t[109] = tempEntity("TE_GUNSHOTDECAL",       "ccc s b");               // origin, entity, decal
+		t[110] = tempEntity("TE_SPRITE_SPRAY",       "ccc ccc s bbb");         // origin, velocity, sprite, count, speed, noise
+		t[111] = tempEntity("TE_ARMOR_RICOCHET",     "ccc b");                 // origin, scale
+		t[112] = tempEntity("TE_PLAYERDECAL",        "b ccc s b");             // player, origin, entity, decal
+		t[113] = tempEntity("TE_BUBBLES",            "ccc ccc c s b c");       // mins, maxs, height, model, count, speed
+		t[114] = tempEntity("TE_BUBBLETRAIL",        "ccc ccc c s b c");
+		t[115] = tempEntity("TE_BLOODSPRITE",        "ccc s s bb");            // origin, spray sprite, drop sprite, color, scale
+		t[116] = tempEntity("TE_WORLDDECAL",         "ccc b");                 // origin, texture
+		t[117] = tempEntity("TE_WORLDDECALHIGH",     "ccc b");                 // origin, texture - 256
+		t[118] = tempEntity("TE_DECALHIGH",          "ccc b s");               // origin, texture - 256, entity
+		t[119] = tempEntity("TE_PROJECTILE",         "ccc ccc s bb");          // origin, velocity, model, life, owner
+		t[120] = tempEntity("TE_SPRAY",              "ccc ccc s bbbb");        // origin, direction, model, count, speed, noise, render mode
+		t[121] = tempEntity("TE_PLAYERSPRITES",      "b s bb");                // player, model, count, variance
+		t[122] = tempEntity("TE_PARTICLEBURST",      "ccc s bb");              // origin, radius, color, duration
+		t[123] = tempEntity("TE_FIREFIELD",          "ccc s s bbb");           // origin, radius, model, count, flags, duration
+		t[124] = tempEntity("TE_PLAYERATTACHMENT",   "b c s s");               // player, vertical offset, model, life
+		t[125] = tempEntity("TE_KILLPLAYERATTACHMENTS", "b");                  // player
+		t[126] = tempEntity("TE_MULTIGUNSHOT",       "ccc ccc cc bb");         // origin, direction, noise x, noise y, count, decal
+		t[127] = tempEntity("TE_USERTRACER",         "ccc ccc bbb");           // origin, velocity, life, color, length
+
+		return t;
+	}
+
+	inline constexpr std::array<TempEntityLayout, 128> TempEntityLayouts = makeTempEntityLayouts();
+
+	// nullptr for types GoldSrc does not define
+	constexpr const TempEntityLayout* findTempEntityLayout(uint8_t type)
+	{
+		return type < TempEntityLayouts.size() && TempEntityLayouts[type].Name ? &TempEntityLayouts[type] : nullptr;
+	}
+
+	// byte counts CL_ParseTEnt reads
+	static_assert(TempEntityLayouts[0].Size == 24 && TempEntityLayouts[1].Size == 20, "beam layouts");
+	static_assert(TempEntityLayouts[28].Size == 16 && TempEntityLayouts[29].Size == 20, "light and text layouts");
+	static_assert(TempEntityLayouts[108].Size == 24 && TempEntityLayouts[123].Size == 13, "model and fire layouts");
+	static_assert(TempEntityLayouts[126].Size == 18 && TempEntityLayouts[127].Size == 15, "tracer layouts");
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <demoanalyser/BufferedFileWriter.h>
+#include <demoanalyser/DemoEvent.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace demo_analyser
+{
+	enum class TextFormat : uint8_t { NDJson, Csv };
+
+	// Event sink writing one NDJSON or CSV file per event type: <prefix><type>.ndjson|.csv
+	// for prints, console_commands, player_states, client_data, entity_updates, user_info,
+	// server_info and event_frames. Output goes through BufferedFileWriter, not iostreams.
+	// NDJSON is valid UTF-8: bytes of a string that do not form UTF-8 are read as Latin-1 and
+	// written as \u00XX. CSV keeps the game's raw bytes.
+	class TextExporter : public DemoEventSink
+	{
+		public:
+			TextExporter(const std::string& prefix, TextFormat format);
+			~TextExporter() override;
+
+			void finish();
+			bool good() const;
+
+			// Paths of the files written, one per table
+			const std::vector<std::string>& files() const { return paths; }
+
+			using DemoEventSink::handle;
+			void handle(DemoEventType type, float time, uint32_t frame, const std::string& text) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const PlayerState& state) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const ClientData& clientData) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const UpdateUserInfo& userInfo) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const ServerInfo& serverInfo) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const EventFrame& eventFrame) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const EntityStatePlayer& entity) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const CustomEntityState& entity) override;
+
+		private:
+			// One output file; fields are written in column order between begin() and end()
+			class Table
+			{
+				public:
+					Table(const std::string& path, TextFormat format, std::vector<const char*> columns);
+
+					void begin(uint32_t frame, float time);
+					void field(int64_t value);
+					void field(float value);
+					void field(std::string_view text);
+					void end();
+
+					BufferedFileWriter& writer() { return out; }
+
+				private:
+					void separator();
+
+					BufferedFileWriter out;
+					TextFormat format;
+					std::vector<const char*> columns;
+					size_t column = 0;
+			};
+
+			std::unique_ptr<Table> prints;
+			std::unique_ptr<Table> consoleCommands;
+			std::unique_ptr<Table> playerStates;
+			std::unique_ptr<Table> clientData;
+			std::unique_ptr<Table> entityUpdates;
+			std::unique_ptr<Table> userInfo;
+			std::unique_ptr<Table> serverInfo;
+			std::unique_ptr<Table> eventFrames;
+			std::vector<std::string> paths;
+	};
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <demoanalyser/BufferedFileWriter.h>
+#include <demoanalyser/DemoEvent.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace demo_analyser
+{
+	// Compact per-player position streams (.hltj).
+	//
+	// Samples are quantized to what the protocol itself carries: origins to 1/8 unit (the
+	// entity_state_player_t origin divisor), angles to 16-bit DT_ANGLE steps and time to
+	// milliseconds. Each track is cut into blocks of up to BlockSamples samples; every block is a
+	// keyframe, its columns start from an absolute value and continue as zigzag varint deltas
+	// (or deltas of deltas, whichever is smaller for that column).
+	//
+	// Track 0 is the recording client (PlayerState frames), tracks 1..maxplayers are player
+	// entities from packet entities messages.
+	//
+	//     TrajectoryWriter writer("match1_trajectories.hltj");
+	//     parser.setEventSink(&writer);
+	//     parser.parseDemo();
+	//     writer.finish();
+	class TrajectoryWriter : public DemoEventSink
+	{
+		public:
+			static constexpr size_t BlockSamples = 256;
+
+			explicit TrajectoryWriter(const std::string& path);
+			~TrajectoryWriter() override;
+
+			// Writes the partial blocks and closes the file; also done on destruction
+			void finish();
+			bool good() const { return out.good(); }
+			uint64_t samplesWritten() const { return samples; }
+
+			using DemoEventSink::handle;
+			void handle(DemoEventType type, float time, uint32_t frame, const PlayerState& state) override;
+			void handle(DemoEventType type, float time, uint32_t frame, const EntityStatePlayer& entity) override;
+
+		private:
+			struct Track
+			{
+				std::vector<int64_t> Columns[7];  // time, x, y, z, pitch, yaw, roll
+				size_t Count = 0;
+			};
+
+			void add(uint32_t entity, float time, const float origin[3], const float angles[3]);
+			void writeBlock(uint32_t entity, Track& track);
+
+			BufferedFileWriter out;
+			std::map<uint32_t, Track> tracks;
+			std::vector<uint8_t> scratch;
+			uint64_t samples = 0;
+			bool finished = false;
+	};
+
+	// One decoded track, structure of arrays in sample order. Time is in seconds, angles in [0, 360)
+	struct Trajectory
+	{
+		uint32_t Entity = 0;
+		std::vector<float> Time;
+		std::vector<float> X, Y, Z;
+		std::vector<float> Pitch, Yaw, Roll;
+	};
+
+	// Decodes a .hltj file into one Trajectory per track, ordered by entity number.
+	// Returns false on a missing file or a malformed stream.
+	bool ReadTrajectories(const std::string& path, std::vector<Trajectory>& trajectories);
+	bool DecodeTrajectories(const uint8_t* data, size_t size, std::vector<Trajectory>& trajectories);
+}
@@ -0,0 +1,169 @@
+#include <demoanalyser/ArrowExporter.h>
+
+#include <cstring>
+
+namespace demo_analyser
+{
+	namespace
+	{
+		// entity_updates.kind
+		enum EntityUpdateKind : uint8_t { PackedPlayer = 0, DeltaPackedPlayer = 1, PackedCustom = 2, DeltaPackedCustom = 3 };
+
+		// every table starts with the frame it came from
+		std::vector<ArrowColumnSpec> withFrameColumns(std::vector<ArrowColumnSpec> columns)
+		{
+			columns.insert(columns.begin(), {{"frame", ArrowType::UInt32}, {"time", ArrowType::Float32}});
+			return columns;
+		}
+	}
+
+	ArrowExporter::ArrowExporter(const std::string& prefix, size_t batchRows)
+	{
+		auto path = [&](const char* name) -> const std::string& {
+			paths.push_back(prefix + name + ".arrows");
+			return paths.back();
+		};
+
+		playerStates = std::make_unique<ArrowStreamWriter>(path("player_states"), withFrameColumns({
+			{"position_x", ArrowType::Float32}, {"position_y", ArrowType::Float32}, {"position_z", ArrowType::Float32},
+			{"rotation_x", ArrowType::Float32}, {"rotation_y", ArrowType::Float32}, {"rotation_z", ArrowType::Float32},
+			{"weapon_flags", ArrowType::UInt32}, {"fov", ArrowType::Float32},
+		}), batchRows);
+
+		entityUpdates = std::make_unique<ArrowStreamWriter>(path("entity_updates"), withFrameColumns({
+			{"kind", ArrowType::UInt8}, {"entity", ArrowType::UInt32},
+			{"origin_x", ArrowType::Float32}, {"origin_y", ArrowType::Float32}, {"origin_z", ArrowType::Float32},
+			{"angles_x", ArrowType::Float32}, {"angles_y", ArrowType::Float32}, {"angles_z", ArrowType::Float32},
+			{"modelindex", ArrowType::Int32}, {"sequence", ArrowType::Int32}, {"gaitsequence", ArrowType::Int32},
+			{"weaponmodel", ArrowType::Int32}, {"team", ArrowType::Int32},
+		}), batchRows);
+
+		clientData = std::make_unique<ArrowStreamWriter>(path("client_data"), withFrameColumns({
+			{"origin_x", ArrowType::Float32}, {"origin_y", ArrowType::Float32}, {"origin_z", ArrowType::Float32},
+			{"velocity_x", ArrowType::Float32}, {"velocity_y", ArrowType::Float32}, {"velocity_z", ArrowType::Float32},
+			{"punchangle_x", ArrowType::Float32}, {"punchangle_y", ArrowType::Float32}, {"punchangle_z", ArrowType::Float32},
+			{"health", ArrowType::Float32}, {"maxspeed", ArrowType::Float32}, {"fov", ArrowType::Float32},
+			{"flags", ArrowType::Int32}, {"weapons", ArrowType::Int32}, {"weapon_id", ArrowType::Int32},
+			{"weaponanim", ArrowType::Int32}, {"deadflag", ArrowType::Int32},
+		}), batchRows);
+
+		prints = std::make_unique<ArrowStreamWriter>(path("prints"),
+			withFrameColumns({{"text", ArrowType::Binary}}), batchRows);
+
+		consoleCommands = std::make_unique<ArrowStreamWriter>(path("console_commands"),
+			withFrameColumns({{"command", ArrowType::Binary}}), batchRows);
+
+		userInfo = std::make_unique<ArrowStreamWriter>(path("user_info"), withFrameColumns({
+			{"client_index", ArrowType::UInt8}, {"user_id", ArrowType::UInt32}, {"info", ArrowType::Binary},
+		}), batchRows);
+	}
+
+	void ArrowExporter::finish()
+	{
+		for (ArrowStreamWriter* writer : {playerStates.get(), entityUpdates.get(), clientData.get(),
+			prints.get(), consoleCommands.get(), userInfo.get()})
+			writer->finish();
+	}
+
+	bool ArrowExporter::good() const
+	{
+		return playerStates->good() && entityUpdates->good() && clientData->good() &&
+			prints->good() && consoleCommands->good() && userInfo->good();
+	}
+
+	void ArrowExporter::handle(DemoEventType type, float time, uint32_t frame, const std::string& text)
+	{
+		ArrowStreamWriter* writer = nullptr;
+		if (type == DemoEventType::MessagePrint)
+			writer = prints.get();
+		else if (type == DemoEventType::ConsoleCommand)
+			writer = consoleCommands.get();
+		else
+			return;
+
+		writer->append(0, frame);
+		writer->append(1, time);
+		writer->appendString(2, text);
+		writer->endRow();
+	}
+
+	void ArrowExporter::handle(DemoEventType, float time, uint32_t frame, const PlayerState& state)
+	{
+		ArrowStreamWriter& w = *playerStates;
+		size_t c = 0;
+		w.append(c++, frame);
+		w.append(c++, time);
+		for (float value : state.position) w.append(c++, value);
+		for (float value : state.rotation) w.append(c++, value);
+		w.append(c++, state.weaponFlags);
+		w.append(c++, state.fov);
+		w.endRow();
+	}
+
+	void ArrowExporter::handle(DemoEventType, float time, uint32_t frame, const ClientData& data)
+	{
+		ArrowStreamWriter& w = *clientData;
+		size_t c = 0;
+		w.append(c++, frame);
+		w.append(c++, time);
+		for (float value : data.origin) w.append(c++, value);
+		for (float value : data.velocity) w.append(c++, value);
+		for (float value : data.punchangle) w.append(c++, value);
+		w.append(c++, data.health);
+		w.append(c++, data.maxspeed);
+		w.append(c++, data.fov);
+		w.append<int32_t>(c++, data.flags);
+		w.append<int32_t>(c++, data.weapons);
+		w.append<int32_t>(c++, data.m_iId);
+		w.append<int32_t>(c++, data.weaponanim);
+		w.append<int32_t>(c++, data.deadflag);
+		w.endRow();
+	}
+
+	void ArrowExporter::handle(DemoEventType, float time, uint32_t frame, const UpdateUserInfo& info)
+	{
+		ArrowStreamWriter& w = *userInfo;
+		w.append(0, frame);
+		w.append(1, time);
+		w.append(2, info.ClientIndex);
+		w.append(3, info.ClientUserID);
+		w.appendString(4, info.ClientUserInfo);
+		w.endRow();
+	}
+
+	void ArrowExporter::handle(DemoEventType type, float time, uint32_t frame, const EntityStatePlayer& entity)
+	{
+		ArrowStreamWriter& w = *entityUpdates;
+		size_t c = 0;
+		w.append(c++, frame);
+		w.append(c++, time);
+		w.append<uint8_t>(c++, type == DemoEventType::PackedPlayerEntity ? PackedPlayer : DeltaPackedPlayer);
+		w.append(c++, entity.entityNumber);
+		for (float value : entity.origin) w.append(c++, value);
+		for (float value : entity.angles) w.append(c++, value);
+		w.append<int32_t>(c++, entity.modelindex);
+		w.append<int32_t>(c++, entity.sequence);
+		w.append<int32_t>(c++, entity.gaitsequence);
+		w.append<int32_t>(c++, entity.weaponmodel);
+		w.append<int32_t>(c++, entity.team);
+		w.endRow();
+	}
+
+	void ArrowExporter::handle(DemoEventType type, float time, uint32_t frame, const CustomEntityState& entity)
+	{
+		ArrowStreamWriter& w = *entityUpdates;
+		size_t c = 0;
+		w.append(c++, frame);
+		w.append(c++, time);
+		w.append<uint8_t>(c++, type == DemoEventType::PackedCustomEntity ? PackedCustom : DeltaPackedCustom);
+		w.append(c++, entity.entityNumber);
+		for (float value : entity.origin) w.append(c++, value);
+		for (float value : entity.angles) w.append(c++, value);
+		w.append<int32_t>(c++, entity.modelindex);
+		w.append<int32_t>(c++, entity.sequence);
+		w.append<int32_t>(c++, 0);  // player-only columns
+		w.append<int32_t>(c++, 0);
+		w.append<int32_t>(c++, 0);
+		w.endRow();
+	}
+}
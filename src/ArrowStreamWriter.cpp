@@ -0,0 +1,331 @@
+#include <demoanalyser/ArrowStreamWriter.h>
+
+#include <algorithm>
+
+namespace demo_analyser
+{
+	namespace
+	{
+		// Arrow format constants (Schema.fbs / Message.fbs)
+		constexpr int16_t MetadataVersionV5 = 4;
+		constexpr uint8_t MessageHeaderSchema = 1;
+		constexpr uint8_t MessageHeaderRecordBatch = 3;
+		constexpr uint8_t TypeInt = 2;
+		constexpr uint8_t TypeFloatingPoint = 3;
+		constexpr uint8_t TypeBinary = 4;
+		constexpr uint8_t TypeUtf8 = 5;
+		constexpr int16_t PrecisionSingle = 1;
+
+		// Minimal flatbuffer encoder. Objects are written front to back and offsets are patched
+		// once the object they point to is written, so every uoffset points forward as required.
+		class FlatBuilder
+		{
+			public:
+				struct Field
+				{
+					uint16_t Id;
+					uint8_t Size;      // 1, 2, 4 or 8
+					uint64_t Value;    // scalar bits; offsets are patched later with link()
+				};
+
+				std::vector<uint8_t> bytes;
+
+				void pad(size_t alignment)
+				{
+					while (bytes.size() % alignment)
+						bytes.push_back(0);
+				}
+
+				template<typename T>
+				size_t scalar(T value)
+				{
+					pad(sizeof(T));
+					size_t position = bytes.size();
+					bytes.resize(position + sizeof(T));
+					std::memcpy(bytes.data() + position, &value, sizeof(T));
+					return position;
+				}
+
+				template<typename T>
+				void store(size_t position, T value)
+				{
+					std::memcpy(bytes.data() + position, &value, sizeof(T));
+				}
+
+				// Points the uoffset at position to target, which must come after it
+				void link(size_t position, size_t target)
+				{
+					store<uint32_t>(position, static_cast<uint32_t>(target - position));
+				}
+
+				// Writes a vtable followed by its table. Returns the table position and the
+				// position of every field, in the order given, for link().
+				size_t table(std::vector<Field> fields, std::vector<size_t>& positions)
+				{
+					uint16_t slots = 0;
+					for (const Field& field : fields)
+						slots = std::max<uint16_t>(slots, field.Id + 1);
+
+					pad(4);
+					size_t vtable = bytes.size();
+					bytes.resize(vtable + 4 + 2 * slots, 0);
+
+					size_t tablePosition = scalar<int32_t>(0);
+
+					// widest first packs the table without gaps
+					std::vector<size_t> order(fields.size());
+					for (size_t i = 0; i < order.size(); ++i)
+						order[i] = i;
+					std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return fields[a].Size > fields[b].Size; });
+
+					positions.assign(fields.size(), 0);
+					for (size_t i : order)
+					{
+						const Field& field = fields[i];
+						size_t position = 0;
+						switch (field.Size) {
+							case 1: position = scalar<uint8_t>(static_cast<uint8_t>(field.Value)); break;
+							case 2: position = scalar<uint16_t>(static_cast<uint16_t>(field.Value)); break;
+							case 4: position = scalar<uint32_t>(static_cast<uint32_t>(field.Value)); break;
+							default: position = scalar<uint64_t>(field.Value); break;
+						}
+						positions[i] = position;
+						store<uint16_t>(vtable + 4 + 2 * field.Id, static_cast<uint16_t>(position - tablePosition));
+					}
+
+					store<uint16_t>(vtable, static_cast<uint16_t>(4 + 2 * slots));
+					store<uint16_t>(vtable + 2, static_cast<uint16_t>(bytes.size() - tablePosition));
+					store<int32_t>(tablePosition, static_cast<int32_t>(tablePosition - vtable));
+
+					return tablePosition;
+				}
+
+				// Vector of offsets (to tables or strings); element positions go to elements
+				size_t offsetVector(size_t count, std::vector<size_t>& elements)
+				{
+					size_t position = scalar<uint32_t>(static_cast<uint32_t>(count));
+					elements.clear();
+					for (size_t i = 0; i < count; ++i)
+						elements.push_back(scalar<uint32_t>(0));
+					return position;
+				}
+
+				// Vector of structs made of two int64 (FieldNode, Buffer)
+				size_t pairVector(const std::vector<std::pair<int64_t, int64_t>>& values)
+				{
+					// the elements, not the length prefix, need 8-byte alignment
+					pad(4);
+					if ((bytes.size() + 4) % 8)
+						scalar<uint32_t>(0);
+
+					size_t position = scalar<uint32_t>(static_cast<uint32_t>(values.size()));
+					for (const auto& value : values) {
+						scalar<int64_t>(value.first);
+						scalar<int64_t>(value.second);
+					}
+					return position;
+				}
+
+				size_t string(const std::string& text)
+				{
+					size_t position = scalar<uint32_t>(static_cast<uint32_t>(text.size()));
+					bytes.insert(bytes.end(), text.begin(), text.end());
+					bytes.push_back(0);
+					return position;
+				}
+		};
+
+		size_t align8(size_t size) { return (size + 7) & ~size_t(7); }
+
+		// columns with an offsets buffer in front of the data
+		bool variableWidth(ArrowType type) { return type == ArrowType::Utf8 || type == ArrowType::Binary; }
+	}
+
+	ArrowStreamWriter::ArrowStreamWriter(const std::string& path, std::vector<ArrowColumnSpec> specs, size_t batchRows_)
+		: out(path, std::ios::binary | std::ios::trunc), batchRows(std::max<size_t>(batchRows_, 1))
+	{
+		for (ArrowColumnSpec& spec : specs) {
+			Column column;
+			column.Spec = std::move(spec);
+			if (variableWidth(column.Spec.Type))
+				column.Offsets.push_back(0);
+			columns.push_back(std::move(column));
+		}
+
+		writeSchema();
+	}
+
+	ArrowStreamWriter::~ArrowStreamWriter()
+	{
+		finish();
+	}
+
+	void ArrowStreamWriter::appendString(size_t column, const char* text, size_t length)
+	{
+		Column& target = columns[column];
+		target.Data.insert(target.Data.end(), text, text + length);
+		target.Offsets.push_back(static_cast<int32_t>(target.Data.size()));
+	}
+
+	void ArrowStreamWriter::endRow()
+	{
+		++rows;
+		++totalRows;
+
+		if (rows >= batchRows)
+			writeBatch();
+	}
+
+	void ArrowStreamWriter::finish()
+	{
+		if (finished)
+			return;
+		finished = true;
+
+		if (rows > 0)
+			writeBatch();
+
+		// end-of-stream: continuation marker and a zero metadata length
+		const uint32_t endOfStream[2] = {0xFFFFFFFFu, 0};
+		out.write(reinterpret_cast<const char*>(endOfStream), sizeof(endOfStream));
+		out.flush();
+	}
+
+	void ArrowStreamWriter::writeMessage(const std::vector<uint8_t>& metadata, const std::vector<std::pair<const void*, size_t>>& body)
+	{
+		// <continuation> <metadata size> <metadata, padded to 8> <body>
+		size_t paddedSize = align8(metadata.size());
+		const uint32_t prefix[2] = {0xFFFFFFFFu, static_cast<uint32_t>(paddedSize)};
+		static const uint8_t zeros[8] = {};
+
+		out.write(reinterpret_cast<const char*>(prefix), sizeof(prefix));
+		out.write(reinterpret_cast<const char*>(metadata.data()), static_cast<std::streamsize>(metadata.size()));
+		out.write(reinterpret_cast<const char*>(zeros), static_cast<std::streamsize>(paddedSize - metadata.size()));
+
+		for (const auto& buffer : body) {
+			out.write(static_cast<const char*>(buffer.first), static_cast<std::streamsize>(buffer.second));
+			out.write(reinterpret_cast<const char*>(zeros), static_cast<std::streamsize>(align8(buffer.second) - buffer.second));
+		}
+	}
+
+	void ArrowStreamWriter::writeSchema()
+	{
+		FlatBuilder builder;
+		std::vector<size_t> fields;
+
+		size_t root = builder.scalar<uint32_t>(0);
+
+		// Message { version, header_type, header, bodyLength }
+		size_t message = builder.table({
+			{0, 2, static_cast<uint16_t>(MetadataVersionV5)},
+			{1, 1, MessageHeaderSchema},
+			{2, 4, 0},
+			{3, 8, 0},
+		}, fields);
+		builder.link(root, message);
+		size_t messageHeader = fields[2];
+
+		// Schema { endianness = Little, fields }
+		size_t schema = builder.table({{0, 2, 0}, {1, 4, 0}}, fields);
+		builder.link(messageHeader, schema);
+		size_t schemaFields = fields[1];
+
+		std::vector<size_t> elements;
+		builder.link(schemaFields, builder.offsetVector(columns.size(), elements));
+
+		for (size_t i = 0; i < columns.size(); ++i)
+		{
+			const ArrowColumnSpec& spec = columns[i].Spec;
+
+			uint8_t typeType = TypeInt;
+			if (spec.Type == ArrowType::Float32) typeType = TypeFloatingPoint;
+			else if (spec.Type == ArrowType::Utf8) typeType = TypeUtf8;
+			else if (spec.Type == ArrowType::Binary) typeType = TypeBinary;
+
+			// Field { name, nullable, type_type, type, children }
+			size_t field = builder.table({{0, 4, 0}, {1, 1, 0}, {2, 1, typeType}, {3, 4, 0}, {5, 4, 0}}, fields);
+			builder.link(elements[i], field);
+			size_t nameField = fields[0], typeField = fields[3], childrenField = fields[4];
+
+			builder.link(nameField, builder.string(spec.Name));
+
+			std::vector<size_t> typeFields;
+			size_t type = 0;
+			switch (spec.Type) {
+				case ArrowType::UInt8:   type = builder.table({{0, 4, 8},  {1, 1, 0}}, typeFields); break;
+				case ArrowType::Int16:   type = builder.table({{0, 4, 16}, {1, 1, 1}}, typeFields); break;
+				case ArrowType::Int32:   type = builder.table({{0, 4, 32}, {1, 1, 1}}, typeFields); break;
+				case ArrowType::UInt32:  type = builder.table({{0, 4, 32}, {1, 1, 0}}, typeFields); break;
+				case ArrowType::Int64:   type = builder.table({{0, 4, 64}, {1, 1, 1}}, typeFields); break;
+				case ArrowType::Float32: type = builder.table({{0, 2, static_cast<uint16_t>(PrecisionSingle)}}, typeFields); break;
+				case ArrowType::Utf8:    type = builder.table({}, typeFields); break;
+				case ArrowType::Binary:  type = builder.table({}, typeFields); break;
+			}
+			builder.link(typeField, type);
+
+			// readers expect the children vector even when it is empty
+			std::vector<size_t> noChildren;
+			builder.link(childrenField, builder.offsetVector(0, noChildren));
+		}
+
+		writeMessage(builder.bytes, {});
+	}
+
+	void ArrowStreamWriter::writeBatch()
+	{
+		std::vector<std::pair<int64_t, int64_t>> nodes;
+		std::vector<std::pair<int64_t, int64_t>> buffers;
+		std::vector<std::pair<const void*, size_t>> body;
+		int64_t bodyOffset = 0;
+
+		auto addBuffer = [&](const void* data, size_t size) {
+			buffers.emplace_back(bodyOffset, static_cast<int64_t>(size));
+			body.emplace_back(data, size);
+			bodyOffset += static_cast<int64_t>(align8(size));
+		};
+
+		for (const Column& column : columns)
+		{
+			nodes.emplace_back(static_cast<int64_t>(rows), 0);
+
+			addBuffer(nullptr, 0);  // no validity bitmap, nothing is null
+			if (variableWidth(column.Spec.Type))
+				addBuffer(column.Offsets.data(), column.Offsets.size() * sizeof(int32_t));
+			addBuffer(column.Data.data(), column.Data.size());
+		}
+
+		FlatBuilder builder;
+		std::vector<size_t> fields;
+
+		size_t root = builder.scalar<uint32_t>(0);
+
+		size_t message = builder.table({
+			{0, 2, static_cast<uint16_t>(MetadataVersionV5)},
+			{1, 1, MessageHeaderRecordBatch},
+			{2, 4, 0},
+			{3, 8, static_cast<uint64_t>(bodyOffset)},
+		}, fields);
+		builder.link(root, message);
+		size_t messageHeader = fields[2];
+
+		// RecordBatch { length, nodes, buffers }
+		size_t batch = builder.table({{0, 8, static_cast<uint64_t>(rows)}, {1, 4, 0}, {2, 4, 0}}, fields);
+		builder.link(messageHeader, batch);
+		size_t nodesField = fields[1], buffersField = fields[2];
+
+		builder.link(nodesField, builder.pairVector(nodes));
+		builder.link(buffersField, builder.pairVector(buffers));
+
+		writeMessage(builder.bytes, body);
+
+		// start the next batch, keeping the allocations
+		for (Column& column : columns) {
+			column.Data.clear();
+			if (variableWidth(column.Spec.Type)) {
+				column.Offsets.clear();
+				column.Offsets.push_back(0);
+			}
+		}
+		rows = 0;
+	}
+}
@@ -0,0 +1,81 @@
+#include <demoanalyser/BufferedFileWriter.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace demo_analyser
+{
+
+	BufferedFileWriter::BufferedFileWriter(const std::string& path, size_t capacity)
+		: buffer(std::max<size_t>(capacity, 64))
+	{
+		fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		failed = fd < 0;
+	}
+
+	BufferedFileWriter::~BufferedFileWriter()
+	{
+		close();
+	}
+
+	void BufferedFileWriter::write(const char* data, size_t size)
+	{
+		if (size > buffer.size() - used) {
+			flush();
+
+			// too big to be worth copying
+			if (size >= buffer.size()) {
+				while (size > 0 && fd >= 0 && !failed) {
+					ssize_t written = ::write(fd, data, size);
+					if (written < 0) {
+						if (errno == EINTR)
+							continue;
+						failed = true;
+						return;
+					}
+					data += written;
+					size -= static_cast<size_t>(written);
+				}
+				return;
+			}
+		}
+
+		std::memcpy(buffer.data() + used, data, size);
+		used += size;
+	}
+
+	void BufferedFileWriter::flush()
+	{
+		size_t offset = 0;
+
+		while (offset < used && fd >= 0 && !failed)
+		{
+			ssize_t written = ::write(fd, buffer.data() + offset, used - offset);
+			if (written < 0) {
+				if (errno == EINTR)
+					continue;
+				failed = true;
+				break;
+			}
+			offset += static_cast<size_t>(written);
+		}
+
+		used = 0;
+	}
+
+	void BufferedFileWriter::close()
+	{
+		if (fd < 0)
+			return;
+
+		flush();
+		if (::close(fd) != 0)
+			failed = true;
+		fd = -1;
+	}
+
+}
@@ -0,0 +1,298 @@
+#include <demoanalyser/ByteSource.h>
+
+#include <demoanalyser/ReadAheadByteSource.h>
+
+#ifdef DEMOANALYSER_WITH_ZLIB
+#include <demoanalyser/GzipByteSource.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace demo_analyser
+{
+
+	MemoryByteSource::MemoryByteSource(const uint8_t* data, size_t size)
+	{
+		setRange(data, size);
+	}
+
+	MemoryByteSource::MemoryByteSource(std::vector<uint8_t> data)
+		: owned(std::move(data))
+	{
+		setRange(owned.data(), owned.size());
+	}
+
+	void MemoryByteSource::setRange(const uint8_t* data, size_t size)
+	{
+		begin = data;
+		length = size;
+		position = 0;
+	}
+
+	size_t MemoryByteSource::read(void* dst, size_t size)
+	{
+		size_t available = position < length ? length - position : 0;
+		size_t count = std::min(size, available);
+
+		if (count > 0)
+			std::memcpy(dst, begin + position, count);
+
+		position += count;
+		if (count < size)
+			ok = false;
+
+		return count;
+	}
+
+	bool MemoryByteSource::seek(int64_t offset, std::ios_base::seekdir origin)
+	{
+		int64_t target = offset;
+		if (origin == std::ios_base::cur) target += static_cast<int64_t>(position);
+		else if (origin == std::ios_base::end) target += static_cast<int64_t>(length);
+
+		if (target < 0 || target > static_cast<int64_t>(length)) {
+			ok = false;
+			return false;
+		}
+
+		position = static_cast<size_t>(target);
+		return true;
+	}
+
+	MappedFileByteSource::MappedFileByteSource(const std::string& path)
+	{
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			ok = false;
+			return;
+		}
+
+		struct stat st{};
+		if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+			::close(fd);
+			ok = false;
+			return;
+		}
+
+		mappingSize = static_cast<size_t>(st.st_size);
+		void* address = ::mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+
+		if (address == MAP_FAILED) {
+			mappingSize = 0;
+			ok = false;
+			return;
+		}
+
+		// frames are read front to back
+		::madvise(address, mappingSize, MADV_SEQUENTIAL);
+
+		mapping = address;
+		setRange(static_cast<const uint8_t*>(mapping), mappingSize);
+	}
+
+	MappedFileByteSource::~MappedFileByteSource()
+	{
+		if (mapping)
+			::munmap(mapping, mappingSize);
+	}
+
+	BufferedByteSource::BufferedByteSource(size_t chunkSize, size_t windowSize_)
+		: buffer(windowSize_ + chunkSize), windowSize(windowSize_)
+	{
+	}
+
+	void BufferedByteSource::resetBuffer(int64_t offset)
+	{
+		bufferStart = offset;
+		bufferLength = 0;
+		position = offset;
+		exhausted = false;
+	}
+
+	bool BufferedByteSource::refill()
+	{
+		if (exhausted)
+			return false;
+
+		// keep the tail of what we have as the lookback window
+		int64_t bufferEnd = bufferStart + static_cast<int64_t>(bufferLength);
+		int64_t keepFrom = std::max(bufferStart, bufferEnd - static_cast<int64_t>(windowSize));
+		size_t keep = static_cast<size_t>(bufferEnd - keepFrom);
+
+		if (keep > 0 && keepFrom != bufferStart)
+			std::memmove(buffer.data(), buffer.data() + (keepFrom - bufferStart), keep);
+
+		bufferStart = keepFrom;
+		bufferLength = keep;
+
+		size_t produced = fill(buffer.data() + bufferLength, buffer.size() - bufferLength);
+		if (produced == 0) {
+			exhausted = true;
+			return false;
+		}
+
+		bufferLength += produced;
+		return true;
+	}
+
+	size_t BufferedByteSource::read(void* dst, size_t size)
+	{
+		uint8_t* out = static_cast<uint8_t*>(dst);
+		size_t total = 0;
+
+		while (total < size)
+		{
+			int64_t bufferEnd = bufferStart + static_cast<int64_t>(bufferLength);
+
+			if (position < bufferStart || position >= bufferEnd) {
+				if (!refill())
+					break;
+				continue;
+			}
+
+			size_t offset = static_cast<size_t>(position - bufferStart);
+			size_t count = std::min(bufferLength - offset, size - total);
+
+			std::memcpy(out + total, buffer.data() + offset, count);
+			position += static_cast<int64_t>(count);
+			total += count;
+		}
+
+		if (total < size)
+			ok = false;
+
+		return total;
+	}
+
+	bool BufferedByteSource::seek(int64_t offset, std::ios_base::seekdir origin)
+	{
+		int64_t target = offset;
+		if (origin == std::ios_base::cur) {
+			target += position;
+		} else if (origin == std::ios_base::end) {
+			if (size() < 0) {
+				ok = false;
+				return false;
+			}
+			target += size();
+		}
+
+		if (target < 0) {
+			ok = false;
+			return false;
+		}
+
+		int64_t bufferEnd = bufferStart + static_cast<int64_t>(bufferLength);
+
+		// inside the window, or reachable by reading ahead
+		if (target >= bufferStart && target <= bufferEnd) {
+			position = target;
+			return true;
+		}
+
+		if (seekRaw(target))
+			return true;
+
+		if (target > bufferEnd) {
+			position = target;  // skipped lazily by the next read
+			return true;
+		}
+
+		ok = false;
+		return false;
+	}
+
+	StreamByteSource::StreamByteSource(std::istream& stream_)
+		: stream(&stream_)
+	{
+		probeSize();
+	}
+
+	StreamByteSource::StreamByteSource(const std::string& path)
+		: owned(std::make_unique<std::ifstream>(path, std::ios::binary)), stream(owned.get())
+	{
+		if (!isOpen())
+			ok = false;
+
+		probeSize();
+	}
+
+	void StreamByteSource::probeSize()
+	{
+		if (!isOpen())
+			return;
+
+		std::streampos start = stream->tellg();
+		if (start == std::streampos(-1)) {
+			stream->clear();
+			return;
+		}
+
+		stream->seekg(0, std::ios::end);
+		std::streampos end = stream->tellg();
+		stream->seekg(start);
+
+		if (end == std::streampos(-1) || !*stream) {
+			stream->clear();
+			return;
+		}
+
+		streamSize = static_cast<int64_t>(end);
+		resetBuffer(static_cast<int64_t>(start));
+	}
+
+	size_t StreamByteSource::fill(uint8_t* dst, size_t size)
+	{
+		if (!stream)
+			return 0;
+
+		stream->read(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(size));
+		return static_cast<size_t>(stream->gcount());
+	}
+
+	bool StreamByteSource::seekRaw(int64_t offset)
+	{
+		if (!seekable() || offset > streamSize)
+			return false;
+
+		stream->clear();
+		stream->seekg(offset, std::ios::beg);
+		if (!*stream)
+			return false;
+
+		resetBuffer(offset);
+		return true;
+	}
+
+	std::unique_ptr<ByteSource> OpenFileByteSource(const std::string& path, bool readAhead)
+	{
+		std::unique_ptr<ByteSource> source;
+
+		if (readAhead) {
+			// explicit reads on the reader thread; a mapping would fault on the parser thread instead
+			source = std::make_unique<ReadAheadByteSource>(std::make_unique<StreamByteSource>(path));
+		} else {
+			auto mapped = std::make_unique<MappedFileByteSource>(path);
+			if (mapped->isOpen())
+				source = std::move(mapped);
+			else
+				source = std::make_unique<StreamByteSource>(path);
+		}
+
+#ifdef DEMOANALYSER_WITH_ZLIB
+		if (source->good() && source->seekable() && GzipByteSource::looksCompressed(*source))
+			return std::make_unique<GzipByteSource>(std::move(source));
+#endif
+
+		return source;
+	}
+
+}
@@ -0,0 +1,154 @@
+#include <demoanalyser/ContentHash.h>
+
+#include <demoanalyser/ByteSource.h>
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace demo_analyser
+{
+	namespace
+	{
+		constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ull;
+		constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4Full;
+		constexpr uint64_t Prime3 = 0x165667B19E3779F9ull;
+		constexpr uint64_t Prime4 = 0x85EBCA77C2B2AE63ull;
+		constexpr uint64_t Prime5 = 0x27D4EB2F165667C5ull;
+
+		uint64_t rotl(uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+
+		uint64_t load64(const uint8_t* data)
+		{
+			uint64_t value;
+			std::memcpy(&value, data, sizeof(value));
+			return value;
+		}
+
+		uint32_t load32(const uint8_t* data)
+		{
+			uint32_t value;
+			std::memcpy(&value, data, sizeof(value));
+			return value;
+		}
+
+		uint64_t round(uint64_t lane, uint64_t input)
+		{
+			lane += input * Prime2;
+			lane = rotl(lane, 31);
+			return lane * Prime1;
+		}
+
+		uint64_t mergeRound(uint64_t hash, uint64_t lane)
+		{
+			hash ^= round(0, lane);
+			return hash * Prime1 + Prime4;
+		}
+	}
+
+	ContentHasher::ContentHasher(uint64_t seed_)
+		: seed(seed_)
+	{
+		lanes[0] = seed + Prime1 + Prime2;
+		lanes[1] = seed + Prime2;
+		lanes[2] = seed;
+		lanes[3] = seed - Prime1;
+	}
+
+	void ContentHasher::update(const void* data, size_t size)
+	{
+		const uint8_t* input = static_cast<const uint8_t*>(data);
+		const uint8_t* end = input + size;
+		totalSize += size;
+
+		if (pendingSize + size < sizeof(pending)) {
+			std::memcpy(pending + pendingSize, input, size);
+			pendingSize += size;
+			return;
+		}
+
+		if (pendingSize > 0) {
+			size_t fill = sizeof(pending) - pendingSize;
+			std::memcpy(pending + pendingSize, input, fill);
+			for (int i = 0; i < 4; ++i)
+				lanes[i] = round(lanes[i], load64(pending + 8 * i));
+			input += fill;
+			pendingSize = 0;
+		}
+
+		// main loop, 32 bytes per stripe
+		while (end - input >= 32) {
+			for (int i = 0; i < 4; ++i)
+				lanes[i] = round(lanes[i], load64(input + 8 * i));
+			input += 32;
+		}
+
+		pendingSize = static_cast<size_t>(end - input);
+		std::memcpy(pending, input, pendingSize);
+	}
+
+	uint64_t ContentHasher::digest() const
+	{
+		uint64_t hash;
+		if (totalSize >= 32) {
+			hash = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+			for (int i = 0; i < 4; ++i)
+				hash = mergeRound(hash, lanes[i]);
+		} else {
+			hash = seed + Prime5;
+		}
+
+		hash += totalSize;
+
+		const uint8_t* input = pending;
+		const uint8_t* end = pending + pendingSize;
+
+		while (end - input >= 8) {
+			hash ^= round(0, load64(input));
+			hash = rotl(hash, 27) * Prime1 + Prime4;
+			input += 8;
+		}
+		if (end - input >= 4) {
+			hash ^= static_cast<uint64_t>(load32(input)) * Prime1;
+			hash = rotl(hash, 23) * Prime2 + Prime3;
+			input += 4;
+		}
+		while (input < end) {
+			hash ^= *input * Prime5;
+			hash = rotl(hash, 11) * Prime1;
+			++input;
+		}
+
+		hash ^= hash >> 33;
+		hash *= Prime2;
+		hash ^= hash >> 29;
+		hash *= Prime3;
+		hash ^= hash >> 32;
+		return hash;
+	}
+
+	bool HashFile(const std::string& path, uint64_t& hash)
+	{
+		MappedFileByteSource mapped(path);
+		if (mapped.isOpen()) {
+			hash = HashBytes(mapped.data(), static_cast<size_t>(mapped.size()));
+			return true;
+		}
+
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+			return false;
+
+		ContentHasher hasher;
+		std::vector<char> buffer(1 << 16);
+		while (file) {
+			file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+			hasher.update(buffer.data(), static_cast<size_t>(file.gcount()));
+		}
+		if (file.bad())
+			return false;
+
+		hash = hasher.digest();
+		return true;
+	}
+}
@@ -0,0 +1,68 @@
+#include <demoanalyser/DeltaStructureCache.h>
+
+#include <algorithm>
+#include <mutex>
+
+namespace demo_analyser
+{
+
+	DeltaStructureCache& DeltaStructureCache::instance()
+	{
+		static DeltaStructureCache cache;
+		return cache;
+	}
+
+	std::shared_ptr<const HalfLifeDeltaStructure> DeltaStructureCache::findLocked(uint64_t hash, const uint8_t* payload, size_t size) const
+	{
+		auto range = entries.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			const std::vector<uint8_t>& cached = it->second.Payload;
+
+			// compare the bytes too, a hash match alone is not proof of the same layout
+			if (cached.size() == size && std::equal(cached.begin(), cached.end(), payload))
+				return it->second.Structure;
+		}
+
+		return nullptr;
+	}
+
+	std::shared_ptr<const HalfLifeDeltaStructure> DeltaStructureCache::find(uint64_t hash, const uint8_t* payload, size_t size) const
+	{
+		std::shared_lock<std::shared_mutex> lock(mutex);
+		return findLocked(hash, payload, size);
+	}
+
+	std::shared_ptr<const HalfLifeDeltaStructure> DeltaStructureCache::insert(uint64_t hash, const uint8_t* payload, size_t size,
+		std::shared_ptr<const HalfLifeDeltaStructure> structure)
+	{
+		std::unique_lock<std::shared_mutex> lock(mutex);
+
+		if (auto existing = findLocked(hash, payload, size))
+			return existing;
+
+		// Full cache: still hand the structure back, just don't keep it
+		if (entries.size() >= MaxEntries)
+			return structure;
+
+		Entry entry;
+		entry.Payload.assign(payload, payload + size);
+		entry.Structure = structure;
+		entries.emplace(hash, std::move(entry));
+
+		return structure;
+	}
+
+	size_t DeltaStructureCache::size() const
+	{
+		std::shared_lock<std::shared_mutex> lock(mutex);
+		return entries.size();
+	}
+
+	void DeltaStructureCache::clear()
+	{
+		std::unique_lock<std::shared_mutex> lock(mutex);
+		entries.clear();
+	}
+
+}
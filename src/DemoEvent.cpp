@@ -0,0 +1,122 @@
+#include <demoanalyser/DemoEvent.h>
+
+#include <demoanalyser/EventHandlers.h>
+
+namespace demo_analyser
+{
+	// Callbacks take some payloads by mutable reference, so those get a copy
+
+	void CallbackEventSink::handle(DemoEventType type, float, uint32_t, const DemoHeader& header)
+	{
+		if (type == DemoEventType::Header && OnReadHeader)
+			OnReadHeader(header);
+		else if (type == DemoEventType::Directory && OnReadDirectory)
+			OnReadDirectory(header);
+	}
+
+	void CallbackEventSink::handle(DemoEventType type, float, uint32_t, const std::string& text)
+	{
+		if (type == DemoEventType::ConsoleCommand && OnConsoleCommand)
+			OnConsoleCommand(text);
+		else if (type == DemoEventType::MessagePrint && OnMessagePrint)
+			OnMessagePrint(text);
+	}
+
+	void CallbackEventSink::handle(DemoEventType, float, uint32_t, const PlayerState& state)
+	{
+		if (OnPlayerState) {
+			PlayerState copy = state;
+			OnPlayerState(copy);
+		}
+	}
+
+	void CallbackEventSink::handle(DemoEventType, float, uint32_t, const EventFrame& eventFrame)
+	{
+		if (OnEventFrame)
+			OnEventFrame(eventFrame);
+	}
+
+	void CallbackEventSink::handle(DemoEventType, float, uint32_t, float value)
+	{
+		if (OnTimeTick)
+			OnTimeTick(value);
+	}
+
+	void CallbackEventSink::handle(DemoEventType, float, uint32_t, const ClientData& clientData)
+	{
+		if (OnClientData) {
+			ClientData copy = clientData;
+			OnClientData(copy);
+		}
+	}
+
+	void CallbackEventSink::handle(DemoEventType, float, uint32_t, const MoveVars& moveVars)
+	{
+		if (OnNewMoveVars) {
+			MoveVars copy = moveVars;
+			OnNewMoveVars(copy);
+		}
+	}
+
+	void CallbackEventSink::handle(DemoEventType, float, uint32_t, const UpdateUserInfo& userInfo)
+	{
+		if (OnUpdateUserInfo) {
+			UpdateUserInfo copy = userInfo;
+			OnUpdateUserInfo(copy);
+		}
+	}
+
+	void CallbackEventSink::handle(DemoEventType, float, uint32_t, const ServerInfo& serverInfo)
+	{
+		if (OnServerInfo) {
+			ServerInfo copy = serverInfo;
+			OnServerInfo(copy);
+		}
+	}
+
+	void CallbackEventSink::handle(DemoEventType, float, uint32_t, const Angle& angle)
+	{
+		if (OnSetAngle)
+			OnSetAngle(angle);
+	}
+
+	void CallbackEventSink::handle(DemoEventType type, float, uint32_t, const EntityStatePlayer& entity)
+	{
+		if (type == DemoEventType::PackedPlayerEntity && OnPackedPlayerEntity)
+			OnPackedPlayerEntity(entity);
+		else if (type == DemoEventType::DeltaPackedPlayerEntity && OnDeltaPackedPlayerEntity)
+			OnDeltaPackedPlayerEntity(entity);
+	}
+
+	void CallbackEventSink::handle(DemoEventType type, float, uint32_t, const CustomEntityState& entity)
+	{
+		if (type == DemoEventType::PackedCustomEntity && OnPackedCustomEntity)
+			OnPackedCustomEntity(entity);
+		else if (type == DemoEventType::DeltaPackedCustomEntity && OnDeltaPackedCustomEntity)
+			OnDeltaPackedCustomEntity(entity);
+	}
+
+	void CallbackEventSink::handle(DemoEventType, float, uint32_t, const ParseDiagnostic& diagnostic)
+	{
+		if (OnParseDiagnostic)
+			OnParseDiagnostic(diagnostic);
+	}
+
+	void CallbackEventSink::handle(DemoEventType, float, uint32_t, const WeaponDataUpdate& weaponData)
+	{
+		if (OnWeaponData)
+			OnWeaponData(weaponData);
+	}
+
+	void CallbackEventSink::handle(DemoEventType, float, uint32_t, const TempEntityBatch& tempEntities)
+	{
+		if (OnTempEntity)
+			OnTempEntity(tempEntities);
+	}
+
+	void CallbackEventSink::handle(DemoEventType, float, uint32_t, const ServerEventBatch& serverEvents)
+	{
+		if (OnServerEvents)
+			OnServerEvents(serverEvents);
+	}
+}
@@ -0,0 +1,203 @@
+#include <demoanalyser/DemoFingerprint.h>
+
+#include <demoanalyser/ContentHash.h>
+#include <demoanalyser/DemoParser.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <unordered_map>
+
+namespace demo_analyser
+{
+	namespace
+	{
+		constexpr size_t SampleWindowSize = 4096;
+		constexpr uint64_t SampleStride = 256 * 1024;
+		constexpr uint64_t HeaderSize = 544;
+
+		void hashString(ContentHasher& hasher, const std::string& text)
+		{
+			uint64_t length = text.size();
+			hasher.update(&length, sizeof(length));
+			hasher.update(text.data(), text.size());
+		}
+
+		template<typename T>
+		void hashValue(ContentHasher& hasher, T value)
+		{
+			hasher.update(&value, sizeof(value));
+		}
+
+		// Picks up the header and the server info, then stops the parse
+		class IdentitySink : public DemoEventSink
+		{
+			public:
+				using DemoEventSink::handle;
+
+				void handle(DemoEventType type, float, uint32_t, const DemoHeader& header) override
+				{
+					if (type != DemoEventType::Header)
+						return;
+
+					hashValue(match, header.networkProtocol);
+					hashValue(match, header.demoProtocol);
+					hashString(match, header.mapName);
+					hashString(match, header.gameFolderName);
+					hashValue(match, header.mapChecksum);
+				}
+
+				void handle(DemoEventType, float, uint32_t, const ServerInfo& serverInfo) override
+				{
+					hashValue(match, serverInfo.Protocol);
+					hashValue(match, serverInfo.SpawnCount);
+					hashValue(match, serverInfo.MapCRC);
+					match.update(serverInfo.ClientDLLHash, sizeof(serverInfo.ClientDLLHash));
+					hashValue(match, serverInfo.MaxPlayers);
+					hashValue(match, serverInfo.IsDeathmatch);
+					hashString(match, serverInfo.GameDir);
+					hashString(match, serverInfo.Hostname);
+					hashString(match, serverInfo.MapFileName);
+					hashString(match, serverInfo.Mapcycle);
+
+					playerIndex = serverInfo.PlayerIndex;
+					found = true;
+					StopParsing();
+				}
+
+				ContentHasher match;
+				uint8_t playerIndex = 0;
+				bool found = false;
+		};
+
+		// A window of bytes every SampleStride bytes past the header, then the total size.
+		// Sources that cannot seek (compressed demos) are read through and hash the same
+		// windows, so a .dem.gz and the .dem inside it get the same fingerprint.
+		bool hashSamples(ByteSource& source, ContentHasher& hasher)
+		{
+			std::vector<uint8_t> buffer(64 * 1024);
+
+			if (source.seekable() && source.size() >= 0) {
+				uint64_t size = static_cast<uint64_t>(source.size());
+				for (uint64_t offset = HeaderSize; offset < size; offset += SampleStride) {
+					if (!source.seek(static_cast<int64_t>(offset), std::ios::beg))
+						return false;
+					size_t count = source.read(buffer.data(), static_cast<size_t>(std::min<uint64_t>(SampleWindowSize, size - offset)));
+					hasher.update(buffer.data(), count);
+				}
+				hashValue(hasher, size);
+				return true;
+			}
+
+			uint64_t position = 0;
+			while (size_t count = source.read(buffer.data(), buffer.size())) {
+				uint64_t end = position + count;
+
+				// every window overlapping this chunk, in order
+				uint64_t window = position > HeaderSize ? (position - HeaderSize) / SampleStride : 0;
+				for (;; ++window) {
+					uint64_t windowStart = HeaderSize + window * SampleStride;
+					uint64_t windowEnd = windowStart + SampleWindowSize;
+					if (windowStart >= end)
+						break;
+
+					uint64_t from = std::max(windowStart, position);
+					uint64_t to = std::min(windowEnd, end);
+					if (from < to)
+						hasher.update(buffer.data() + (from - position), to - from);
+				}
+
+				position = end;
+			}
+
+			hashValue(hasher, position);
+			return true;
+		}
+	}
+
+	DemoFingerprint FingerprintDemo(const std::string& path)
+	{
+		DemoFingerprint fingerprint;
+
+		try {
+			IdentitySink identity;
+			DemoParser parser(OpenFileByteSource(path));
+			parser.setEventSink(&identity);
+
+			// every message but the server info is only walked over
+			parser.parseDemo(ParseRequest().onlyMessages({static_cast<uint8_t>(SVCMessage::SVC_SERVERINFO)}));
+
+			if (!identity.found) {
+				fingerprint.Error = "No server info in the demo";
+				return fingerprint;
+			}
+
+			fingerprint.Match = identity.match.digest();
+
+			ContentHasher content;
+			hashValue(content, fingerprint.Match);
+			hashValue(content, identity.playerIndex);
+
+			std::unique_ptr<ByteSource> source = OpenFileByteSource(path);
+			if (!source->good() || !hashSamples(*source, content)) {
+				fingerprint.Error = "Failed to read demo data";
+				return fingerprint;
+			}
+
+			fingerprint.Content = content.digest();
+			fingerprint.Valid = true;
+		} catch (const std::exception& ex) {
+			fingerprint.Error = ex.what();
+		}
+
+		return fingerprint;
+	}
+
+	std::vector<DemoFingerprint> FingerprintDemos(const std::vector<std::string>& paths, unsigned threads)
+	{
+		std::vector<DemoFingerprint> fingerprints(paths.size());
+
+		if (threads == 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		threads = static_cast<unsigned>(std::min<size_t>(threads, paths.size()));
+
+		std::atomic<size_t> nextPath{0};
+		auto work = [&]() {
+			for (size_t i = nextPath++; i < paths.size(); i = nextPath++)
+				fingerprints[i] = FingerprintDemo(paths[i]);
+		};
+
+		std::vector<std::thread> workers;
+		for (unsigned i = 1; i < threads; ++i)
+			workers.emplace_back(work);
+		work();
+
+		for (std::thread& worker : workers)
+			worker.join();
+
+		return fingerprints;
+	}
+
+	std::vector<std::vector<size_t>> GroupDemos(const std::vector<DemoFingerprint>& fingerprints, DemoGrouping by)
+	{
+		std::vector<std::vector<size_t>> groups;
+		std::unordered_map<uint64_t, size_t> groupIndex;
+
+		for (size_t i = 0; i < fingerprints.size(); ++i) {
+			const DemoFingerprint& fingerprint = fingerprints[i];
+			if (!fingerprint.Valid)
+				continue;
+
+			uint64_t key = by == DemoGrouping::Content ? fingerprint.Content : fingerprint.Match;
+			auto found = groupIndex.emplace(key, groups.size());
+			if (found.second)
+				groups.emplace_back();
+			groups[found.first->second].push_back(i);
+		}
+
+		groups.erase(std::remove_if(groups.begin(), groups.end(),
+			[](const std::vector<size_t>& group) { return group.size() < 2; }), groups.end());
+		return groups;
+	}
+}
@@ -3,23 +3,37 @@
 #include "demoanalyser/EventHandlers.h"
 #include <demoanalyser/DemoParser.h>
 #include <demoanalyser/DeltaParsers.h>
+#include <demoanalyser/DeltaStructureCache.h>
+#include <demoanalyser/KnownDeltaLayouts.h>
+#include <demoanalyser/TempEntityLayouts.h>
 
+#include <cassert>
 #include <cstdint>
-#include <fstream>
 #include <limits>
 #include <memory>
 #include <stdexcept>
+#include <type_traits>
 #include <iostream>
 
 namespace demo_analyser
 {
 
 	DemoParser::DemoParser(const std::string& path)
-		: file(path, std::ios::binary | std::ios::ate)
-	{	
-		if (!file.is_open()) {
+		: DemoParser(OpenFileByteSource(path))
+	{
+		if (!source->good()) {
 			std::cerr << "Error opening file: " << path << "\n";
 		}
+	}
+
+	DemoParser::DemoParser(const uint8_t* data, size_t size)
+		: DemoParser(std::make_unique<MemoryByteSource>(data, size))
+	{
+	}
+
+	DemoParser::DemoParser(std::unique_ptr<ByteSource> source_)
+		: source(std::move(source_))
+	{
 
 		{
 			AddMessageHandler(
@@ -191,6 +205,18 @@ namespace demo_analyser
 				[this]() { MessageTempEntity(); }
 			);
 
+			AddMessageHandler(
+				static_cast<uint8_t>(SVCMessage::SVC_EVENT),
+				0,
+				[this]() { MessageEvent(); }
+			);
+
+			AddMessageHandler(
+				static_cast<uint8_t>(SVCMessage::SVC_EVENT_RELIABLE),
+				0,
+				[this]() { MessageEventReliable(); }
+			);
+
 			AddMessageHandler(
 				static_cast<uint8_t>(SVCMessage::SVC_DELTAPACKETENTITIES),
 				0,
@@ -215,7 +241,7 @@ namespace demo_analyser
 				[this]() { MessagePing(); }
 			);
 		}
-		auto deltaDescription = std::make_unique<HalfLifeDeltaStructure>("delta_description_t");
+		auto deltaDescription = std::make_shared<HalfLifeDeltaStructure>("delta_description_t");
 
 		deltaDescription->addEntry("flags", 32, 1.0f, HalfLifeDeltaStructure::EntryFlags::Integer);
 		deltaDescription->addEntry("name", 8, 1.0f, HalfLifeDeltaStructure::EntryFlags::String);
@@ -229,152 +255,369 @@ namespace demo_analyser
 		
 	}
 
-	void DemoParser::parseDemo()
+	namespace
 	{
-		// --- Read full file size ---
-		file.seekg(0, std::ios::end);
-		std::streampos endPos = file.tellg();
-		if (endPos == std::streampos(-1))
-			throw std::runtime_error("Failed to get file size");
+		// parser whose callbacks are running on this thread, for StopParsing()
+		thread_local DemoParser* activeParser = nullptr;
 
-		size_t fileSize = static_cast<size_t>(endPos);
-		file.seekg(0, std::ios::beg);
+		struct ActiveParserScope
+		{
+			DemoParser* previous;
+
+			explicit ActiveParserScope(DemoParser* parser) : previous(activeParser) { activeParser = parser; }
+			~ActiveParserScope() { activeParser = previous; }
+		};
+	}
+
+	void StopParsing()
+	{
+		if (activeParser)
+			activeParser->requestStop();
+	}
+
+	const PlayerTable* CurrentPlayers()
+	{
+		return activeParser ? &activeParser->getPlayers() : nullptr;
+	}
+
+	const ResourceTable* CurrentResources()
+	{
+		return activeParser ? &activeParser->getResources() : nullptr;
+	}
+
+	ParseStatus DemoParser::parseDemo()
+	{
+		return parseDemo(ParseRequest());
+	}
+
+	ParseStatus DemoParser::parseDemo(const ParseRequest& request_)
+	{
+		ActiveParserScope scope(this);
+
+		pullMode = false;
+		beginParse(request_);
+
+		while (!parseFrame()) {}
+
+		return status;
+	}
+
+	void DemoParser::beginEvents(const ParseRequest& request_)
+	{
+		ActiveParserScope scope(this);
+
+		pullMode = true;
+		pullStarted = true;
+		pullFinished = false;
+		events.clear();
+		eventCursor = 0;
+
+		beginParse(request_);
+	}
+
+	const DemoEvent* DemoParser::next()
+	{
+		if (!pullStarted)
+			beginEvents();
+
+		ActiveParserScope scope(this);
+
+		// one frame at a time, only the current frame's events are held
+		while (eventCursor >= events.size())
+		{
+			if (pullFinished)
+				return nullptr;
+
+			events.clear();
+			eventCursor = 0;
+			std::apply([](auto&... pool) { ((pool.used = 0), ...); }, payloads);
+			pullFinished = parseFrame();
+		}
+
+		return &events[eventCursor++];
+	}
+
+	template<typename Callback, typename T>
+	void DemoParser::Emit(DemoEventType type, Callback* callback, T& value)
+	{
+		assert(DemoEventCarries<std::remove_const_t<T>>(type));
+
+		// the rest of the message is still decoded, for the state, but reported to nobody
+		if (stopRequested)
+			return;
+
+		if (pullMode) {
+			DemoEvent& event = events.emplace_back();
+			event.Type = type;
+			event.Timestamp = currentFrame.Timestamp;
+			event.FrameNumber = currentFrame.Number;
+			event.Data = &std::get<PayloadPool<std::remove_const_t<T>>>(payloads).store(value);
+			return;
+		}
+
+		if (eventSink) {
+			eventSink->handle(type, currentFrame.Timestamp, currentFrame.Number, value);
+			return;
+		}
+
+		if (callback)
+			callback(value);
+	}
+
+	void DemoParser::beginParse(const ParseRequest& request_)
+	{
+		request = request_;
+		stopRequested = false;
+		status = ParseStatus::Completed;
+		diagnostics.clear();
+		currentDirectory = 0;
+		currentFrame = FrameHeader{};
+		playerEntities.clear();
+		customEntities.clear();
+		players.reset(0);
+		resources.clear();
+		weapons = {};
+
+		if (!source || !source->good())
+			throw std::runtime_error("Failed to open demo source");
+
+		// --- Total size, unknown (-1) for sequential streams ---
+		int64_t fileSize = source->size();
 
 		// --- Read demo header (always 544 bytes) ---
 		std::vector<uint8_t> headerData(544);
-		file.read(reinterpret_cast<char*>(headerData.data()), headerData.size());
+		if (source->read(headerData.data(), headerData.size()) != headerData.size())
+			throw std::runtime_error("Failed to read demo header");
 
-		readDemoHeader(file, headerData, fileSize);
+		readDemoHeader(headerData, fileSize);
 
 		Seek(544, std::ios::beg);
+	}
+
+	// Decodes one frame. Returns true, with the status set, once the parse is over
+	bool DemoParser::parseFrame()
+	{
+		if (stopRequested) {
+			status = ParseStatus::Stopped;
+			return true;
+		}
+
+		if (request.Cancellation) {
+			if (request.Cancellation->isCancelled()) {
+				status = ParseStatus::Cancelled;
+				return true;
+			}
+			if (request.Cancellation->deadlineExceeded()) {
+				status = ParseStatus::DeadlineExceeded;
+				return true;
+			}
+		}
 
-		uint8_t currentDirectory = 0;
+		int64_t frameOffset = source->tell();
+		FrameHeader frameHeader = ReadFrameHeader();
+		currentFrame = frameHeader;
 
-		while (true)
+		currentMessageId = 0;
+		currentMessageOffset = 0;
+
+		if (!source->good())
 		{
-			FrameHeader frameHeader = ReadFrameHeader();
+			if (!recoverErrors)
+				throw std::runtime_error("Unexpected end of demo file");
+
+			RecordDiagnostic(frameOffset, frameHeader, "Unexpected end of demo file");
+			status = ParseStatus::Completed;
+			return true;
+		}
 
-			switch (frameHeader.Type)
+		// nothing after the time window is wanted
+		if (currentDirectory == 1 && frameHeader.Type != 5 && frameHeader.Timestamp > request.EndTime) {
+			status = ParseStatus::Completed;
+			return true;
+		}
+
+		frameEvents = request.wantsFrame(frameHeader.Type, frameHeader.Timestamp);
+
+		// Unwanted frames are skipped by offset, except game data that later frames depend
+		// on (decoded without callbacks): the loading segment, and playback frames before
+		// the window, which keep the parser's state current
+		bool gameData = frameHeader.Type == 0 || frameHeader.Type == 1;
+		bool stateGameData = gameData && (currentDirectory == 0 ||
+			(request.FrameTypes.test(frameHeader.Type) && frameHeader.Timestamp < request.StartTime));
+		if (!frameEvents && frameHeader.Type != 5 && !stateGameData) {
+			SkipFrame(frameHeader.Type);
+			return false;
+		}
+
+		switch (frameHeader.Type)
+		{
+			// ------------------------------------------------------------
+			// Frame Type 0 or 1 : Game Data Frames
+			// ------------------------------------------------------------
+			case 0:
+			case 1:
 			{
-				// ------------------------------------------------------------
-				// Frame Type 0 or 1 : Game Data Frames
-				// ------------------------------------------------------------
-				case 0:
-				case 1:
-				{
-					GameDataFrameHeader gameDataHeader = ReadGameDataFrameHeader();
+				GameDataFrameHeader gameDataHeader = ReadGameDataFrameHeader();
 
-					if (gameDataHeader.Length == 0)
-						break;
+				if (gameDataHeader.Length == 0)
+					break;
 
-					std::vector<uint8_t> frameData(gameDataHeader.Length);
-					file.read(reinterpret_cast<char*>(frameData.data()), gameDataHeader.Length);
+				std::vector<uint8_t> frameData(gameDataHeader.Length);
+				source->read(frameData.data(), gameDataHeader.Length);
 
-					try {
-						ParseGameDataMessages(frameData);
+				std::string error;
+
+				try {
+					if (!ParseGameDataMessages(frameData)) {
+						error = DescribeDecodeError();
+
+						// the whole frame is already read, so the file sits on the next frame header
+						if (recoverErrors) {
+							RecordDiagnostic(frameOffset, frameHeader, error, bitBuffer->getError(), bitBuffer->getErrorBit());
+							break;
+						}
 					}
-					catch (const std::exception& ex) {
-						throw std::runtime_error(
-							std::string("Error parsing gamedata frame: ") + ex.what()
-						);
+				}
+				catch (const std::exception& ex) {
+					if (recoverErrors) {
+						RecordDiagnostic(frameOffset, frameHeader, ex.what());
+						break;
 					}
 
-					break;
+					error = ex.what();
 				}
 
-				// ------------------------------------------------------------
-				// Frame Type 3 : Console Command
-				// ------------------------------------------------------------
-				case 3:
-				{
-					std::vector<uint8_t> frameData(64);
-					file.read(reinterpret_cast<char*>(frameData.data()), frameData.size());
+				if (!error.empty()) {
+					throw std::runtime_error("Error parsing gamedata frame: " + error);
+				}
 
-					bitBuffer = std::make_unique<BitBuffer>(frameData);
-					std::string command = bitBuffer->readString(64);
+				break;
+			}
+
+			// ------------------------------------------------------------
+			// Frame Type 3 : Console Command
+			// ------------------------------------------------------------
+			case 3:
+			{
+				std::vector<uint8_t> frameData(64);
+				source->read(frameData.data(), frameData.size());
 
-					if (OnConsoleCommand)
-						OnConsoleCommand(command);
+				bitBuffer = std::make_unique<BitBuffer>(frameData);
+				std::string command = bitBuffer->readString(64);
 
-					break;
-				}
+				Emit(DemoEventType::ConsoleCommand, OnConsoleCommand, command);
+
+				break;
+			}
 
-				// ------------------------------------------------------------
-				// Frame Type 4 : Player State
-				// ------------------------------------------------------------
-				case 4:
+			// ------------------------------------------------------------
+			// Frame Type 4 : Player State
+			// ------------------------------------------------------------
+			case 4:
+			{
+				try
 				{
-					try
-					{
-						std::vector<uint8_t> frameData(32);
-						file.read(reinterpret_cast<char*>(frameData.data()), frameData.size());
+					std::vector<uint8_t> frameData(32);
+					source->read(frameData.data(), frameData.size());
 
-						bitBuffer = std::make_unique<BitBuffer>(frameData);
+					bitBuffer = std::make_unique<BitBuffer>(frameData);
 
-						PlayerState state;
-						state.position[0] = bitBuffer->readFloat();
-						state.position[1] = bitBuffer->readFloat();
-						state.position[2] = bitBuffer->readFloat();
+					PlayerState state;
+					state.position[0] = bitBuffer->readFloat();
+					state.position[1] = bitBuffer->readFloat();
+					state.position[2] = bitBuffer->readFloat();
 
-						state.rotation[0] = bitBuffer->readFloat();
-						state.rotation[1] = bitBuffer->readFloat();
-						state.rotation[2] = bitBuffer->readFloat();
+					state.rotation[0] = bitBuffer->readFloat();
+					state.rotation[1] = bitBuffer->readFloat();
+					state.rotation[2] = bitBuffer->readFloat();
 
-						state.weaponFlags = bitBuffer->readUInt32();
-						state.fov         = bitBuffer->readFloat();
+					state.weaponFlags = bitBuffer->readUInt32();
+					state.fov         = bitBuffer->readFloat();
 
-						if (OnPlayerState)
-							OnPlayerState(state);
-					}
-					catch (const std::exception& ex)
-					{
-						throw std::runtime_error(
-							std::string("Error parsing player state frame: ") + ex.what()
-						);
+					if (bitBuffer->hasError())
+						throw std::runtime_error(DescribeDecodeError());
+
+					Emit(DemoEventType::PlayerState, OnPlayerState, state);
+				}
+				catch (const std::exception& ex)
+				{
+					if (recoverErrors) {
+						RecordDiagnostic(frameOffset, frameHeader, ex.what());
+						break;
 					}
 
-					break;
+					throw std::runtime_error(
+						std::string("Error parsing player state frame: ") + ex.what()
+					);
 				}
 
-				// ------------------------------------------------------------
-				// Frame Type 5 : Directory
-				// ------------------------------------------------------------
-				case 5:
-					if (currentDirectory == 1)
-						return; // end of demo
-					currentDirectory++;
-					break;
+				break;
+			}
 
-				// ------------------------------------------------------------
-				// Frame Type 6 : Event Frame (network messages)
-				// ------------------------------------------------------------
-				case 6:
-				{
-					std::vector<uint8_t> frameData(84);
-					file.read(reinterpret_cast<char*>(frameData.data()), frameData.size());
+			// ------------------------------------------------------------
+			// Frame Type 5 : Directory
+			// ------------------------------------------------------------
+			case 5:
+				if (currentDirectory == 1) {
+					if (directoryPending)
+						readPendingDirectory();
+					status = ParseStatus::Completed; // end of demo
+					return true;
+				}
+				currentDirectory++;
+				break;
 
-					EventFrame eventFrame = ParseEventFrame(frameData);
+			// ------------------------------------------------------------
+			// Frame Type 6 : Event Frame (network messages)
+			// ------------------------------------------------------------
+			case 6:
+			{
+				std::vector<uint8_t> frameData(84);
+				source->read(frameData.data(), frameData.size());
 
-					if (OnEventFrame)
-						OnEventFrame(eventFrame);
+				EventFrame eventFrame = ParseEventFrame(frameData);
 
-					break;
-				}
+				Emit(DemoEventType::EventFrame, OnEventFrame, eventFrame);
 
-				// ------------------------------------------------------------
-				// Unknown / unhandled frame types
-				// ------------------------------------------------------------
-				default:
-					SkipFrame(frameHeader.Type);
-					break;
+				break;
 			}
+
+			// ------------------------------------------------------------
+			// Unknown / unhandled frame types
+			// ------------------------------------------------------------
+			default:
+				SkipFrame(frameHeader.Type);
+				break;
 		}
+
+		return false;
 	}
 
 
-	void DemoParser::readDemoHeader(std::ifstream &file, const std::vector<uint8_t>& headerData, const uint32_t fileSize) 
+	void DemoParser::RecordDiagnostic(int64_t frameOffset, const FrameHeader& frameHeader, const std::string& error,
+		DecodeError code, size_t errorBit)
+	{
+		ParseDiagnostic diagnostic;
+		diagnostic.frameOffset = frameOffset;
+		diagnostic.frameNumber = frameHeader.Number;
+		diagnostic.timestamp = frameHeader.Timestamp;
+		diagnostic.frameType = frameHeader.Type;
+		diagnostic.messageId = currentMessageId;
+		diagnostic.messageOffset = currentMessageOffset;
+		diagnostic.code = code;
+		diagnostic.errorBit = static_cast<uint32_t>(errorBit);
+		diagnostic.error = error;
+
+		Emit(DemoEventType::Diagnostic, OnParseDiagnostic, diagnostic);
+
+		diagnostics.push_back(std::move(diagnostic));
+	}
+
+	void DemoParser::readDemoHeader(const std::vector<uint8_t>& headerData, const int64_t fileSize) 
 	{
-		DemoHeader header;
+		DemoHeader& header = demoHeader;
+		header = DemoHeader();
+		directoryPending = false;
 
 		bitBuffer = std::make_unique<BitBuffer>(headerData);
 		
@@ -397,6 +640,15 @@ namespace demo_analyser
 
 		header.directoryOffset = bitBuffer->readUInt32();
 
+		// The directory sits at the end of the demo; a forward-only source only gets there
+		// after the last frame, so the entries are read then and reported via OnReadDirectory
+		if (!source->seekable() || fileSize < 0) {
+			directoryPending = true;
+
+			Emit(DemoEventType::Header, OnReadHeader, header);
+			return;
+		}
+
 		constexpr size_t DirectoryEntrySize = 92;
 		uint32_t expectedOffset = static_cast<uint32_t>(fileSize - 4 - (DirectoryEntrySize * 2));
 
@@ -410,10 +662,18 @@ namespace demo_analyser
 			throw std::runtime_error("Unexpected directory entries offset");
 		}
 		
-		file.seekg(header.directoryOffset, std::ios::beg);
-		
+		source->seek(header.directoryOffset, std::ios::beg);
+		readDemoDirectory();
+
+		Emit(DemoEventType::Header, OnReadHeader, header);
+	}
+
+	void DemoParser::readDemoDirectory()
+	{
+		DemoHeader& header = demoHeader;
+
 		std::vector<uint8_t> directoryEntriesData(4 + 2 * 92);
-		file.read(reinterpret_cast<char*>(directoryEntriesData.data()), directoryEntriesData.size());
+		source->read(directoryEntriesData.data(), directoryEntriesData.size());
 		bitBuffer = std::make_unique<BitBuffer>(directoryEntriesData);
 
 		int32_t nDirectoryEntries = 0;
@@ -434,20 +694,36 @@ namespace demo_analyser
 			header.demoDirectory[i].offset = bitBuffer->readInt32(); // offset
 			header.demoDirectory[i].fileLength = bitBuffer->readInt32(); // length
 		}
+	}
+
+	void DemoParser::readPendingDirectory()
+	{
+		directoryPending = false;
+
+		// Same pass: skip forward to the directory instead of reopening the source
+		if (demoHeader.directoryOffset < source->tell() || !source->seek(demoHeader.directoryOffset, std::ios::beg))
+			return;
 
-		if(OnReadHeader)
-			OnReadHeader(header);
+		try {
+			readDemoDirectory();
+		} catch (const std::exception& e) {
+			if (!recoverErrors)
+				throw;
+			return;
+		}
+
+		Emit(DemoEventType::Directory, OnReadDirectory, demoHeader);
 	}
 
 	FrameHeader DemoParser::ReadFrameHeader()
 	{
 		FrameHeader header{};
 
-		file.read(reinterpret_cast<char*>(&header.Type), sizeof(header.Type));
+		source->read(&header.Type, sizeof(header.Type));
 
-		file.read(reinterpret_cast<char*>(&header.Timestamp), sizeof(header.Timestamp));
+		source->read(&header.Timestamp, sizeof(header.Timestamp));
 
-		file.read(reinterpret_cast<char*>(&header.Number), sizeof(header.Number));
+		source->read(&header.Number, sizeof(header.Number));
 
 		return header;
 	}
@@ -457,6 +733,17 @@ namespace demo_analyser
 		int32_t length = 0;
 
 		switch (frameType) {
+			case 0:
+			case 1: {
+				// 464 bytes of frame info, then the message length
+				source->seek(464, std::ios::cur);
+				uint32_t val = 0;
+				source->read(&val, sizeof(val));
+				source->seek(-468, std::ios::cur);
+				length = 468 + val;
+				break;
+			}
+
 			case 2:
 				// TODO: unknown type
 				break;
@@ -481,19 +768,19 @@ namespace demo_analyser
 				break;
 
 			case 8: {
-				file.seekg(4, std::ios::cur);
-				int32_t val;
-				file.read(reinterpret_cast<char*>(&val), sizeof(val));
-				file.seekg(-8, std::ios::cur);
+				source->seek(4, std::ios::cur);
+				int32_t val = 0;
+				source->read(&val, sizeof(val));
+				source->seek(-8, std::ios::cur);
 				length = val + 24;
 				break;
 			}
 
 			case 9: {
-				int32_t val;
-				file.read(reinterpret_cast<char*>(&val), sizeof(val));
+				int32_t val = 0;
+				source->read(&val, sizeof(val));
 				length = 4 + val;
-				file.seekg(-4, std::ios::cur);
+				source->seek(-4, std::ios::cur);
 				break;
 			}
 
@@ -507,7 +794,7 @@ namespace demo_analyser
 	void DemoParser::SkipFrame(uint8_t frameType) 
 	{
 		int32_t length = GetFrameLength(frameType);
-		file.seekg(length, std::ios::cur);
+		source->seek(length, std::ios::cur);
 	}
 
 	GameDataFrameHeader DemoParser::ReadGameDataFrameHeader() 
@@ -515,22 +802,20 @@ namespace demo_analyser
 		GameDataFrameHeader header{};
 
 		Seek(220);
-		file.read(reinterpret_cast<char*>(&header.ResolutionWidth), sizeof(header.ResolutionWidth));
-		file.read(reinterpret_cast<char*>(&header.ResolutionHeight), sizeof(header.ResolutionHeight));
+		source->read(&header.ResolutionWidth, sizeof(header.ResolutionWidth));
+		source->read(&header.ResolutionHeight, sizeof(header.ResolutionHeight));
 
 
 		Seek(236);
 
 
-		file.read(reinterpret_cast<char*>(&header.Length), sizeof(header.Length));
+		source->read(&header.Length, sizeof(header.Length));
 
 		return header;
 	}
 
-	void DemoParser::ParseGameDataMessages(const std::vector<uint8_t>& frameData)
+	bool DemoParser::ParseGameDataMessages(const std::vector<uint8_t>& frameData)
 	{
-		int64_t gameDataStartOffset = file.tellg() - static_cast<std::streamoff>(frameData.size());
-
 		// load bit buffer
 		bitBuffer = std::make_unique<BitBuffer>(frameData);
 		readingGameData = true;
@@ -541,18 +826,17 @@ namespace demo_analyser
 				int32_t messageFrameOffset = bitBuffer->currentByte();
 				uint8_t messageId = bitBuffer->readByte();
 
-				std::string messageName = SVCMessageName(messageId);
-				if (messageName.empty())
-					messageName = FindMessageIdString(messageId);
+				currentMessageOffset = messageFrameOffset;
+				currentMessageId = messageId;
+				emitEvents = frameEvents && request.wantsMessage(messageId);
 
 				MessageHandler* handler = FindMessageHandler(messageId);
 				
 				if (!handler)
-					throw std::runtime_error(
-						"Unknown message handler for ID " + std::to_string(messageId)
-					);
-
-				if (handler->Callback)
+				{
+					bitBuffer->fail(DecodeError::UnknownMessage, messageId);
+				}
+				else if (handler->Callback)
 				{
 					handler->Callback();
 				}
@@ -570,24 +854,58 @@ namespace demo_analyser
 					}
 					else
 					{
-						throw std::runtime_error(
-							"Unknown variable-length message ID " + std::to_string(messageId)
-						);
+						bitBuffer->fail(DecodeError::UnknownMessage, messageId);
 					}
 				}
 
+				// one error check per message, the buffer keeps the first failure
+				if (bitBuffer->hasError())
+				{
+					readingGameData = false;
+					ClearFrameBatches();
+					return false;
+				}
+
 				// end of frame?
-				if (bitBuffer->currentByte() == bitBuffer->length() || !readingGameData)
+				if (bitBuffer->currentByte() == bitBuffer->length() || !readingGameData || stopRequested)
 					break;
 			}
 		}
 		catch (...) {
 			readingGameData = false;
-			file.close();
+			ClearFrameBatches();
 			throw;
 		}
 
 		readingGameData = false;
+		if (stopRequested)
+			ClearFrameBatches();
+		else
+			EmitFrameBatches();
+		return true;
+	}
+
+	std::string DemoParser::DescribeDecodeError() const
+	{
+		std::string description = DecodeErrorName(bitBuffer->getError());
+
+		switch (bitBuffer->getError())
+		{
+			case DecodeError::UnknownMessage:
+			case DecodeError::UnknownTempEntity:
+			case DecodeError::InvalidBitCount:
+				description += " " + std::to_string(bitBuffer->getErrorValue());
+				break;
+			default:
+				break;
+		}
+
+		std::string messageName = SVCMessageName(currentMessageId);
+		if (messageName.empty())
+			messageName = "message " + std::to_string(currentMessageId);
+
+		return description + " (" + messageName + " at byte " + std::to_string(currentMessageOffset) +
+			", bit " + std::to_string(bitBuffer->getErrorBit()) + ")";
 	}
 
 	void DemoParser::AddMessageHandler(uint8_t id, int32_t length, std::function<void()> callback)
@@ -637,39 +955,106 @@ namespace demo_analyser
 		return "";
 	}
 
+	void DemoParser::BindDeltaSlot(const HalfLifeDeltaStructure* structure)
+	{
+		auto bind = [structure](DeltaSlot& slot, bool knownLayout) {
+			slot.Structure = structure;
+			slot.KnownLayout = knownLayout;
+		};
+
+		const std::string& name = structure->getName();
+
+		if (name == EntityStatePlayerLayout::Name)
+			bind(entityStatePlayerDelta, matchesKnownLayout<EntityStatePlayerLayout>(*structure));
+		else if (name == EntityStateLayout::Name)
+			bind(entityStateDelta, matchesKnownLayout<EntityStateLayout>(*structure));
+		else if (name == CustomEntityStateLayout::Name)
+			bind(customEntityStateDelta, matchesKnownLayout<CustomEntityStateLayout>(*structure));
+		else if (name == ClientDataLayout::Name)
+			bind(clientDataDelta, matchesKnownLayout<ClientDataLayout>(*structure));
+		else if (name == WeaponDataLayout::Name)
+			bind(weaponDataDelta, matchesKnownLayout<WeaponDataLayout>(*structure));
+		else if (name == EventLayout::Name)
+			bind(eventDelta, matchesKnownLayout<EventLayout>(*structure));
+	}
+
+	template <typename Layout>
+	void DemoParser::ReadDelta(const DeltaSlot& slot, typename Layout::Target& out)
+	{
+		if (!slot.Structure) {
+			bitBuffer->fail(DecodeError::MissingDeltaStructure);
+			return;
+		}
+
+		if (slot.KnownLayout) {
+			decodeKnownDelta<Layout>(*bitBuffer, out);
+			return;
+		}
+
+		// Modded server layout, decode generically and convert by name
+		HalfLifeDelta delta = slot.Structure->createDelta();
+		slot.Structure->readDelta(*bitBuffer, &delta);
+		mergeDeltaFields<Layout>(delta, Layout::fromDelta(delta), out);
+	}
+
+	template <typename Layout>
+	void DemoParser::SkipDelta(const DeltaSlot& slot)
+	{
+		if (!slot.Structure) {
+			bitBuffer->fail(DecodeError::MissingDeltaStructure);
+			return;
+		}
+
+		if (slot.KnownLayout) {
+			typename Layout::Target discarded{};
+			decodeKnownDelta<Layout>(*bitBuffer, discarded);
+			return;
+		}
+
+		slot.Structure->readDelta(*bitBuffer);
+	}
+
 	void DemoParser::MessageClientData()
 	{
 		// Read delta sequence bit
 		bool deltaSequence = bitBuffer->readBoolean();
-		uint8_t deltaMask;
+		uint8_t deltaMask = 0;
 		if (deltaSequence) {
 			deltaMask = bitBuffer->readByte();
 		}
 
 		// Read clientdata delta block
-		auto clientdata_delta_structure = GetDeltaStructure("clientdata_t");
-
-		HalfLifeDelta halflifedelta = clientdata_delta_structure->createDelta();
+		if (Wants(OnClientData)) {
+			ClientData clientData{};
+			ReadDelta<ClientDataLayout>(clientDataDelta, clientData);
 
-		clientdata_delta_structure->readDelta(*bitBuffer, &halflifedelta);
+			clientData.delta_sequence = deltaSequence;
+			clientData.delta_mask = deltaMask;
 
-		ClientData clientData = toClientData(halflifedelta);
-
-		clientData.delta_sequence = deltaSequence;
-		clientData.delta_mask = deltaMask;
+			Emit(DemoEventType::ClientData, OnClientData, clientData);
+		} else {
+			SkipDelta<ClientDataLayout>(clientDataDelta);
+		}
 
-		if(OnClientData)
-			OnClientData(clientData);
+		// Weapon loop: deltas apply to the weapon's last state, collected into one batch
+		bool wantWeapons = Wants(OnWeaponData);
+		weaponUpdate.weapons.clear();
 
-		// Weapon loop
 		while (bitBuffer->readBoolean())
 		{
-			bitBuffer->seekBits(6);
+			uint32_t weaponIndex = bitBuffer->readUnsignedBits(6);
+
+			WeaponData& weapon = weapons[weaponIndex];
+			ReadDelta<WeaponDataLayout>(weaponDataDelta, weapon);
+			weapon.weaponIndex = weaponIndex;
 
-			// Read weapon_data_t delta
-			GetDeltaStructure("weapon_data_t")->readDelta(*bitBuffer);
+			if (wantWeapons)
+				weaponUpdate.weapons.push_back(weapon);
 		}
 
+		if (!weaponUpdate.weapons.empty())
+			Emit(DemoEventType::WeaponData, OnWeaponData, weaponUpdate);
+
 		// Skip until end of message frame
 		bitBuffer->skipRemainingBits();
 
@@ -685,17 +1070,15 @@ namespace demo_analyser
 		angle.yaw = bitBuffer->readInt16();
 		angle.roll = bitBuffer->readInt16();
 
-		if(OnSetAngle)
-			OnSetAngle(angle);
+		if (Wants(OnSetAngle))
+			Emit(DemoEventType::SetAngle, OnSetAngle, angle);
 	}
 
 	void DemoParser::MessagePrint()
     {
         std::string str = bitBuffer->readString();
-		if(OnMessagePrint)
-		{
-			OnMessagePrint(str);
-		}
+		if (Wants(OnMessagePrint))
+			Emit(DemoEventType::MessagePrint, OnMessagePrint, str);
     }
 
 	void DemoParser::MessageServerInfo() {
@@ -712,6 +1095,13 @@ namespace demo_analyser
 		serverInfo.MaxPlayers = bitBuffer->readByte();
 		maxClients = serverInfo.MaxPlayers;
 
+		// a new level starts with no entities, players are sent again as they connect
+		playerEntities.clear();
+		customEntities.clear();
+		players.reset(maxClients);
+		resources.clear();
+		weapons = {};
+
 		serverInfo.PlayerIndex = bitBuffer->readByte();
 		serverInfo.IsDeathmatch = bitBuffer->readByte();
 
@@ -728,8 +1118,8 @@ namespace demo_analyser
 			Seek(21);
 		}
 
-		if(OnServerInfo)
-			OnServerInfo(serverInfo);
+		if (Wants(OnServerInfo))
+			Emit(DemoEventType::ServerInfo, OnServerInfo, serverInfo);
 
 		serverInfoParsed = true;
 	}
@@ -743,15 +1133,73 @@ namespace demo_analyser
 
 	void DemoParser::MessageDeltaDescription()
     {
+		// The payload starts and ends on a byte boundary, so it can be hashed as raw bytes
+		size_t startBit = bitBuffer->currentBitOffset();
+
+		if (startBit % 8 == 0)
+		{
+			// Skim to the end of the message without building anything
+			bitBuffer->skipString();
+			uint32_t nEntries = bitBuffer->readUnsignedBits(16);
+
+			for (uint32_t i = 0; i < nEntries; i++)
+			{
+				NoDeltaTarget discarded;
+				decodeKnownDelta<DeltaDescriptionLayout>(*bitBuffer, discarded);
+			}
+
+			bitBuffer->skipRemainingBits();
+
+			if (bitBuffer->hasError())
+				return;
+
+			const uint8_t* payload = bitBuffer->getData().data() + startBit / 8;
+			size_t payloadSize = bitBuffer->currentByte() - startBit / 8;
+			uint64_t hash = hashDeltaDescription(payload, payloadSize);
+
+			DeltaStructureCache& cache = DeltaStructureCache::instance();
+
+			if (auto cached = cache.find(hash, payload, payloadSize))
+			{
+				AddDeltaStructure(std::move(cached));
+				bitBuffer->setEndian(EndianType::Little);
+				return;
+			}
+
+			bitBuffer->seekBits(static_cast<int>(startBit), std::ios_base::beg);
+
+			auto newDeltaStructure = ReadDeltaDescription();
+			if (bitBuffer->hasError())
+				return;
+
+			AddDeltaStructure(cache.insert(hash, payload, payloadSize, std::move(newDeltaStructure)));
+		}
+		else
+		{
+			auto newDeltaStructure = ReadDeltaDescription();
+			if (bitBuffer->hasError())
+				return;
+
+			AddDeltaStructure(std::move(newDeltaStructure));
+		}
+
+        bitBuffer->skipRemainingBits();
+		bitBuffer->setEndian(EndianType::Little);
+	}
+
+	std::shared_ptr<const HalfLifeDeltaStructure> DemoParser::ReadDeltaDescription()
+	{
         std::string structureName = bitBuffer->readString();
 
         uint32_t nEntries = bitBuffer->readUnsignedBits(16);
 
-		auto newDeltaStructure = std::make_unique<HalfLifeDeltaStructure>(structureName);
+		auto newDeltaStructure = std::make_shared<HalfLifeDeltaStructure>(structureName);
 
-		// Add it to delta dictionary
-		
-        HalfLifeDeltaStructure* deltaDescription = GetDeltaStructure("delta_description_t");
+        const HalfLifeDeltaStructure* deltaDescription = GetDeltaStructure("delta_description_t");
+		if (!deltaDescription) {
+			bitBuffer->fail(DecodeError::MissingDeltaStructure);
+			return newDeltaStructure;
+		}
 
         for (uint16_t i = 0; i < nEntries; i++)
         {
@@ -761,10 +1209,7 @@ namespace demo_analyser
             newDeltaStructure->addEntry(newDelta);
         }
 
-		AddDeltaStructure(std::move(newDeltaStructure));
-
-        bitBuffer->skipRemainingBits();
-		bitBuffer->setEndian(EndianType::Little);
+		return newDeltaStructure;
 	}
 
 	void DemoParser::MessageNewMoveVars()
@@ -846,8 +1291,8 @@ namespace demo_analyser
 
 		mv.skyName = bitBuffer->readString();
 
-		if(OnNewMoveVars)
-			OnNewMoveVars(mv);
+		if (Wants(OnNewMoveVars))
+			Emit(DemoEventType::NewMoveVars, OnNewMoveVars, mv);
 
         //Seek(98);
         //bitBuffer->readString();
@@ -872,8 +1317,10 @@ namespace demo_analyser
 		auto data = bitBuffer->readBytes(16);
 		memcpy(updateUserInfo.ClientCDKeyHash, data.data(), 16);
 
-		if(OnUpdateUserInfo)
-			OnUpdateUserInfo(updateUserInfo);
+		players.update(updateUserInfo.ClientIndex, updateUserInfo.ClientUserID, updateUserInfo.ClientUserInfo, updateUserInfo.ClientCDKeyHash);
+
+		if (Wants(OnUpdateUserInfo))
+			Emit(DemoEventType::UpdateUserInfo, OnUpdateUserInfo, updateUserInfo);
 	}
 
 	void DemoParser::MessageResourceList() {
@@ -881,12 +1328,16 @@ namespace demo_analyser
 		uint32_t nEntries = bitBuffer->readUnsignedBits(12);
 
 		for (int32_t i = 0; i < static_cast<int32_t>(nEntries); ++i) {
-			bitBuffer->seekBits(4);           // entry type
-			bitBuffer->readString();           // entry name
-			bitBuffer->seekBits(36);           // index (12 bits) + file size (24 bits), signed?
+			uint32_t type = bitBuffer->readUnsignedBits(4);
+			std::string name = bitBuffer->readString();
+			uint32_t index = bitBuffer->readUnsignedBits(12);
+			uint32_t size = bitBuffer->readUnsignedBits(24);
 
 			uint32_t flags = bitBuffer->readUnsignedBits(3);
 
+			if (type < ResourceTypeCount)
+				resources.add(static_cast<ResourceType>(type), index, name, size, static_cast<uint8_t>(flags));
+
 			if ((flags & 4) != 0) {           // md5 hash present
 				bitBuffer->seekBytes(16);      // skip hash
 			}
@@ -909,7 +1360,7 @@ namespace demo_analyser
 	}
 
 	void DemoParser::MessageSpawnBaseline() {
-		while (true) {
+		while (!bitBuffer->hasError()) {
 			uint32_t entityIndex = bitBuffer->readUnsignedBits(11);
 
 			if (entityIndex == (1u << 11) - 1) {  // all 1's
@@ -917,29 +1368,27 @@ namespace demo_analyser
 			}
 
 			uint32_t entityType = bitBuffer->readUnsignedBits(2);
-			std::string entityTypeString;
 
 			if ((entityType & 1) != 0) {  // is bit 1 set?
 				if (entityIndex > 0 && entityIndex <= maxClients) {
-					entityTypeString = "entity_state_player_t";
+					SkipDelta<EntityStatePlayerLayout>(entityStatePlayerDelta);
 				} else {
-					entityTypeString = "entity_state_t";
+					SkipDelta<EntityStateLayout>(entityStateDelta);
 				}
 			} else {
-				entityTypeString = "custom_entity_state_t";
+				SkipDelta<CustomEntityStateLayout>(customEntityStateDelta);
 			}
-
-			GetDeltaStructure(entityTypeString)->readDelta(*bitBuffer);
 		}
 
 		uint32_t footer = bitBuffer->readUnsignedBits(5);  // should be all 1's
 		if (footer != (1u << 5) - 1) {
-			throw std::runtime_error("Bad svc_spawnbaseline footer.");
+			bitBuffer->fail(DecodeError::BadFooter, static_cast<int32_t>(footer));
+			return;
 		}
 
 		uint32_t nExtraData = bitBuffer->readUnsignedBits(6);
 		for (int32_t i = 0; i < static_cast<int32_t>(nExtraData); ++i) {
-			GetDeltaStructure("entity_state_t")->readDelta(*bitBuffer);
+			SkipDelta<EntityStateLayout>(entityStateDelta);
 		}
 
 		bitBuffer->setEndian(EndianType::Little);
@@ -1000,6 +1449,15 @@ namespace demo_analyser
         Seek(4); // unsigned int
         bitBuffer->readString(); // The cvar.
     }
+	// State slot for an entity number, grown on demand (numbers are 11 bits)
+	template <typename T>
+	static T& entitySlot(std::vector<T>& table, uint32_t entityNumber)
+	{
+		if (entityNumber >= table.size())
+			table.resize(entityNumber + 1);
+		return table[entityNumber];
+	}
+
 	void DemoParser::MessagePacketEntities() 
 	{
 		// Skip num entities (16 bits, not reliable)
@@ -1039,32 +1497,28 @@ namespace demo_analyser
 				bitBuffer->seekBits(6);  // baseline index
 			}
 
-			std::string entityType = "entity_state_t";
-
 			if (entityNumber > 0 && entityNumber <= maxClients) 
 			{
-				entityType = "entity_state_player_t";
+				// always decoded: later delta-packed updates apply on top of this state
+				EntityStatePlayer& entityStatePlayer = entitySlot(playerEntities, entityNumber);
+				entityStatePlayer = {};
+				ReadDelta<EntityStatePlayerLayout>(entityStatePlayerDelta, entityStatePlayer);
+				entityStatePlayer.entityNumber = entityNumber;
 
-			} else if (custom) {
-				entityType = "custom_entity_state_t";
-			}
-
-			auto delta_structure = GetDeltaStructure(entityType);
+				if (Wants(OnPackedPlayerEntity))
+					Emit(DemoEventType::PackedPlayerEntity, OnPackedPlayerEntity, entityStatePlayer);
 
-			HalfLifeDelta halflifedelta = delta_structure->createDelta();
-
-			delta_structure->readDelta(*bitBuffer, &halflifedelta);
+			} else if (custom) {
+				CustomEntityState& customEntityState = entitySlot(customEntities, entityNumber);
+				customEntityState = {};
+				ReadDelta<CustomEntityStateLayout>(customEntityStateDelta, customEntityState);
+				customEntityState.entityNumber = entityNumber;
 
-			if (entityNumber > 0 && entityNumber <= maxClients) 
-			{
-				EntityStatePlayer entityStatePlayer = toEntityStatePlayer(halflifedelta);
-				if(OnPackedPlayerEntity)
-					OnPackedPlayerEntity(entityStatePlayer);
+				if (Wants(OnPackedCustomEntity))
+					Emit(DemoEventType::PackedCustomEntity, OnPackedCustomEntity, customEntityState);
 
-			} else if (custom) {
-				CustomEntityState customEntityState = toCustomEntityState(halflifedelta);
-				if(OnPackedCustomEntity)
-					OnPackedCustomEntity(customEntityState);
+			} else {
+				SkipDelta<EntityStateLayout>(entityStateDelta);
 			}
 		}
 
@@ -1076,240 +1530,147 @@ namespace demo_analyser
 	{
 		uint8_t type = bitBuffer->readByte();
 
-		switch (type) {
-			// obsolete
-			case 16: // TE_BEAM
-			case 26: // TE_BEAMHOSE
-				break;
-
-			// simple coord format messages
-			case 2:  // TE_GUNSHOT
-			case 4:  // TE_TAREXPLOSION
-			case 9:  // TE_SPARKS
-			case 10: // TE_LAVASPLASH
-			case 11: // TE_TELEPORT
-				Seek(6);
-				break;
-
-			case 0:  // TE_BEAMPOINTS
-				Seek(24);
-				break;
-
-			case 1:  // TE_BEAMENTPOINT
-				Seek(20);
-				break;
-
-			case 3:  // TE_EXPLOSION
-				Seek(11);
-				break;
-
-			case 5:  // TE_SMOKE
-				Seek(10);
-				break;
-
-			case 6:  // TE_TRACER
-				Seek(12);
-				break;
-
-			case 7:  // TE_LIGHTNING
-				Seek(17);
-				break;
-
-			case 8:  // TE_BEAMENTS
-				Seek(16);
-				break;
+		const TempEntityLayout* layout = findTempEntityLayout(type);
+		if (!layout) {
+			// the body length is not known, nothing after it in the frame can be read
+			bitBuffer->fail(DecodeError::UnknownTempEntity, type);
+			return;
+		}
 
-			case 12: // TE_EXPLOSION2
-				Seek(8);
-				break;
+		if (!Wants(OnTempEntity) && layout->Tail == TempEntityTail::None) {
+			bitBuffer->seekBytes(layout->Size);
+			return;
+		}
 
-			case 13: { // TE_BSPDECAL
-				Seek(8);
-				uint16_t entityIndex = bitBuffer->readUInt16();
-				if (entityIndex != 0) {
-					Seek(2);
-				}
-				break;
+		TempEntity& entity = tempEntities.entities.emplace_back();
+		entity.type = type;
+		entity.valueCount = layout->FieldCount;
+		entity.textOffset = static_cast<uint32_t>(tempEntities.text.size());
+		entity.textLength = 0;
+
+		for (uint8_t i = 0; i < layout->FieldCount; ++i) {
+			switch (layout->Fields[i]) {
+				case TempEntityField::Byte:  entity.values[i] = bitBuffer->readByte(); break;
+				case TempEntityField::Short: entity.values[i] = bitBuffer->readInt16(); break;
+				case TempEntityField::Coord: entity.values[i] = bitBuffer->readInt16() * (1.0f / 8); break;
+				case TempEntityField::Angle: entity.values[i] = bitBuffer->readByte() * (360.0f / 256); break;
 			}
+		}
 
-			case 14: // TE_IMPLOSION
-				Seek(9);
-				break;
-
-			case 15: // TE_SPRITETRAIL
-				Seek(19);
-				break;
-
-			case 17: // TE_SPRITE
-				Seek(10);
-				break;
-
-			case 18: // TE_BEAMSPRITE
-				Seek(16);
-				break;
-
-			case 19: // TE_BEAMTORUS
-			case 20: // TE_BEAMDISK
-			case 21: // TE_BEAMCYLINDER
-				Seek(24);
+		switch (layout->Tail) {
+			case TempEntityTail::None:
 				break;
 
-			case 22: // TE_BEAMFOLLOW
-				Seek(10);
+			case TempEntityTail::BspDecal:
+				if (entity.values[layout->FieldCount - 1] != 0)
+					entity.values[entity.valueCount++] = bitBuffer->readInt16();
 				break;
 
-			case 23: // TE_GLOWSPRITE
-				Seek(11);
+			case TempEntityTail::TextMessage:
+				if (entity.values[3] == 2)
+					entity.values[entity.valueCount++] = bitBuffer->readInt16();
+				for (uint8_t c = bitBuffer->readByte(); c != 0 && !bitBuffer->hasError(); c = bitBuffer->readByte())
+					tempEntities.text.push_back(static_cast<char>(c));
+				entity.textLength = static_cast<uint16_t>(tempEntities.text.size() - entity.textOffset);
 				break;
+		}
 
-			case 24: // TE_BEAMRING
-				Seek(16);
-				break;
+		// only decoded to find the end of the message
+		if (!Wants(OnTempEntity)) {
+			tempEntities.text.resize(entity.textOffset);
+			tempEntities.entities.pop_back();
+		}
+	}
 
-			case 25: // TE_STREAK_SPLASH
-				Seek(19);
-				break;
+	void DemoParser::MessageEvent()
+	{
+		uint32_t eventCount = bitBuffer->readUnsignedBits(5);
 
-			case 27: // TE_DLIGHT
-				Seek(12);
-				break;
+		for (uint32_t i = 0; i < eventCount && !bitBuffer->hasError(); ++i) {
+			ServerEvent discarded;
+			ServerEvent& event = QueueServerEvent(discarded);
 
-			case 28: // TE_ELIGHT
-				Seek(16);
-				break;
+			event.eventIndex = bitBuffer->readUnsignedBits(10);
+			event.reliable = 0;
 
-			case 29: { // TE_TEXTMESSAGE
-				Seek(5);
-				uint8_t textParmsEffect = bitBuffer->readByte();
-				Seek(14);
-				if (textParmsEffect == 2) {
-					Seek(2);
+			if (bitBuffer->readBoolean()) {
+				event.packetIndex = bitBuffer->readUnsignedBits(11);
+				if (bitBuffer->readBoolean()) {
+					event.hasArgs = 1;
+					ReadServerEventArgs(event, &event != &discarded);
 				}
-				bitBuffer->readString(); // capped to 512 bytes
-				break;
 			}
 
-			case 30: // TE_LINE
-			case 31: // TE_BOX
-				Seek(17);
-				break;
-
-			case 99:  // TE_KILLBEAM
-				Seek(2);
-				break;
-
-			case 100: // TE_LARGEFUNNEL
-				Seek(10);
-				break;
-
-			case 101: // TE_BLOODSTREAM
-				Seek(14);
-				break;
-
-			case 102: // TE_SHOWLINE
-				Seek(12);
-				break;
-
-			case 103: // TE_BLOOD
-				Seek(14);
-				break;
-
-			case 104: // TE_DECAL
-				Seek(9);
-				break;
-
-			case 105: // TE_FIZZ
-				Seek(5);
-				break;
-
-			case 106: // TE_MODEL
-				Seek(17);
-				break;
-
-			case 107: // TE_EXPLODEMODEL
-				Seek(13);
-				break;
-
-			case 108: // TE_BREAKMODEL
-				Seek(24);
-				break;
-
-			case 109: // TE_GUNSHOTDECAL
-				Seek(9);
-				break;
-
-			case 110: // TE_SPRITE_SPRAY
-				Seek(17);
-				break;
-
-			case 111: // TE_ARMOR_RICOCHET
-				Seek(7);
-				break;
-
-			case 112: // TE_PLAYERDECAL
-				Seek(10);
-				break;
-
-			case 113: // TE_BUBBLES
-			case 114: // TE_BUBBLETRAIL
-				Seek(19);
-				break;
+			if (bitBuffer->readBoolean())
+				event.delay = bitBuffer->readUnsignedBits(16) / 100.0f;
+		}
 
-			case 115: // TE_BLOODSPRITE
-				Seek(12);
-				break;
+		bitBuffer->skipRemainingBits();
+		bitBuffer->setEndian(EndianType::Little);
+	}
 
-			case 116: // TE_WORLDDECAL
-			case 117: // TE_WORLDDECALHIGH
-				Seek(7);
-				break;
+	void DemoParser::MessageEventReliable()
+	{
+		ServerEvent discarded;
+		ServerEvent& event = QueueServerEvent(discarded);
 
-			case 118: // TE_DECALHIGH
-				Seek(9);
-				break;
+		event.eventIndex = bitBuffer->readUnsignedBits(10);
+		event.reliable = 1;
+		event.hasArgs = 1;
+		ReadServerEventArgs(event, &event != &discarded);
 
-			case 119: // TE_PROJECTILE
-				Seek(16);
-				break;
+		if (bitBuffer->readBoolean())
+			event.delay = bitBuffer->readUnsignedBits(16) / 100.0f;
 
-			case 120: // TE_SPRAY
-				Seek(18);
-				break;
+		bitBuffer->skipRemainingBits();
+		bitBuffer->setEndian(EndianType::Little);
+	}
 
-			case 121: // TE_PLAYERSPRITES
-				Seek(5);
-				break;
+	ServerEvent& DemoParser::QueueServerEvent(ServerEvent& discarded)
+	{
+		ServerEvent* event = &discarded;
 
-			case 122: // TE_PARTICLEBURST
-				Seek(10);
-				break;
+		if (Wants(OnServerEvents)) {
+			if (serverEventBatch.count < serverEvents.size())
+				event = &serverEvents[serverEventBatch.count++];
+			else
+				++serverEventBatch.dropped;
+		}
 
-			case 123: // TE_FIREFIELD
-				Seek(9);
-				break;
+		*event = ServerEvent{};
+		event->packetIndex = -1;
+		return *event;
+	}
 
-			case 124: // TE_PLAYERATTACHMENT
-				Seek(7);
-				break;
+	void DemoParser::ReadServerEventArgs(ServerEvent& event, bool wanted)
+	{
+		// args are sent against zeros, not against an earlier event
+		if (wanted)
+			ReadDelta<EventLayout>(eventDelta, event.args);
+		else
+			SkipDelta<EventLayout>(eventDelta);
+	}
 
-			case 125: // TE_KILLPLAYERATTACHMENTS
-				Seek(1);
-				break;
+	void DemoParser::EmitFrameBatches()
+	{
+		if (!tempEntities.entities.empty())
+			Emit(DemoEventType::TempEntity, OnTempEntity, tempEntities);
 
-			case 126: // TE_MULTIGUNSHOT
-				Seek(18);
-				break;
+		if (serverEventBatch.count > 0 || serverEventBatch.dropped > 0) {
+			serverEventBatch.events = serverEvents.data();
+			Emit(DemoEventType::ServerEvents, OnServerEvents, serverEventBatch);
+		}
 
-			case 127: // TE_USERTRACER
-				Seek(15);
-				break;
+		ClearFrameBatches();
+	}
 
-			default: {
-				std::ostringstream oss;
-				oss << "Unknown tempentity type \"" << static_cast<int>(type) << "\".";
-				throw std::runtime_error(oss.str());
-			}
-		}
+	// Drops the batches of a frame that failed or was stopped, nothing of it is emitted
+	void DemoParser::ClearFrameBatches()
+	{
+		tempEntities.entities.clear();
+		tempEntities.text.clear();
+		serverEventBatch.count = 0;
+		serverEventBatch.dropped = 0;
 	}
 
 	void DemoParser::MessageDeltaPacketEntities() 
@@ -1341,33 +1702,32 @@ namespace demo_analyser
 			if (!removeEntity) {
 				bool custom = bitBuffer->readBoolean();
 
-				std::string entityType = "entity_state_t";
-
-				if (entityNumber > 0 && entityNumber <= maxClients) {
-					entityType = "entity_state_player_t";
-				} else if (custom) {
-					entityType = "custom_entity_state_t";
-				}
-
-				auto delta_structure = GetDeltaStructure(entityType);
-
-				HalfLifeDelta halflifedelta = delta_structure->createDelta();
-
-				delta_structure->readDelta(*bitBuffer, &halflifedelta);
-
 				if (entityNumber > 0 && entityNumber <= maxClients) 
 				{
-					EntityStatePlayer entityStatePlayer = toEntityStatePlayer(halflifedelta);
-					if(OnDeltaPackedPlayerEntity)
-						OnDeltaPackedPlayerEntity(entityStatePlayer);
+					// applied to the entity's last state whether or not anyone listens
+					EntityStatePlayer& entityStatePlayer = entitySlot(playerEntities, entityNumber);
+					ReadDelta<EntityStatePlayerLayout>(entityStatePlayerDelta, entityStatePlayer);
+					entityStatePlayer.entityNumber = entityNumber;
+
+					if (Wants(OnDeltaPackedPlayerEntity))
+						Emit(DemoEventType::DeltaPackedPlayerEntity, OnDeltaPackedPlayerEntity, entityStatePlayer);
 
 				} else if (custom) {
-					CustomEntityState customEntityState = toCustomEntityState(halflifedelta);
-					if(OnDeltaPackedCustomEntity)
-						OnDeltaPackedCustomEntity(customEntityState);
-				}
+					CustomEntityState& customEntityState = entitySlot(customEntities, entityNumber);
+					ReadDelta<CustomEntityStateLayout>(customEntityStateDelta, customEntityState);
+					customEntityState.entityNumber = entityNumber;
 
-				
+					if (Wants(OnDeltaPackedCustomEntity))
+						Emit(DemoEventType::DeltaPackedCustomEntity, OnDeltaPackedCustomEntity, customEntityState);
+
+				} else {
+					SkipDelta<EntityStateLayout>(entityStateDelta);
+				}
+			} else {
+				if (entityNumber < playerEntities.size())
+					playerEntities[entityNumber] = {};
+				if (entityNumber < customEntities.size())
+					customEntities[entityNumber] = {};
 			}
 		}
 
@@ -1429,8 +1789,8 @@ namespace demo_analyser
 	{
 		float time = bitBuffer->readFloat();
 
-		if(OnTimeTick)
-			OnTimeTick(time);
+		if (Wants(OnTimeTick))
+			Emit(DemoEventType::TimeTick, OnTimeTick, time);
 	}
 
 	void DemoParser::MessageUserDefault()
@@ -1442,11 +1802,13 @@ namespace demo_analyser
 	void DemoParser::Seek(std::streamoff offset, std::ios_base::seekdir origin) 
 	{
 		if (readingGameData) {
-            if (offset > std::numeric_limits<int32_t>::max())
-                throw std::runtime_error("Offset too large for BitBuffer seek");
+            if (offset > std::numeric_limits<int32_t>::max()) {
+                bitBuffer->fail(DecodeError::Overflow);
+                return;
+            }
             bitBuffer->seekBytes(static_cast<int32_t>(offset), origin);
         } else {
-            file.seekg(offset, origin);
+            source->seek(offset, origin);
         }
 	}
 
@@ -0,0 +1,328 @@
+#include <demoanalyser/DemoParserC.h>
+
+#include <demoanalyser/DemoParser.h>
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <string>
+
+using namespace demo_analyser;
+
+struct demo_parser
+{
+	std::unique_ptr<DemoParser> parser;
+	ParseRequest request;
+	bool started = false;
+	bool finished = false;
+	bool failed = false;
+	std::string error;
+	std::string mapName;
+
+	// event that did not fit the last batch, read first by the next one; stays valid
+	// because next() is not called again until it is consumed
+	const DemoEvent* pending = nullptr;
+};
+
+namespace
+{
+	// Both error setters are called from catch blocks, so they must not throw themselves
+	void copyError(const char* message, char* error, size_t errorSize) noexcept
+	{
+		if (!error || errorSize == 0)
+			return;
+		size_t length = std::min(std::strlen(message), errorSize - 1);
+		std::memcpy(error, message, length);
+		error[length] = '\0';
+	}
+
+	void setError(demo_parser& parser, const char* message) noexcept
+	{
+		try {
+			parser.error = message;
+		} catch (...) {
+			parser.error.clear();  // out of memory: the status still reports the failure
+		}
+	}
+
+	demo_parser* open(std::unique_ptr<ByteSource> source, const char* what, char* error, size_t errorSize)
+	{
+		try {
+			if (!source->good()) {
+				copyError((std::string("Failed to open ") + what).c_str(), error, errorSize);
+				return nullptr;
+			}
+
+			std::unique_ptr<demo_parser> handle(new demo_parser);
+			handle->parser = std::make_unique<DemoParser>(std::move(source));
+			copyError("", error, errorSize);
+			return handle.release();
+		} catch (const std::exception& ex) {
+			copyError(ex.what(), error, errorSize);
+			return nullptr;
+		} catch (...) {
+			copyError("Unknown error", error, errorSize);
+			return nullptr;
+		}
+	}
+
+	void fill(demo_entity_update& out, const EntityStatePlayer& entity)
+	{
+		out.kind = DEMO_ENTITY_PLAYER;
+		out.entity = entity.entityNumber;
+		std::memcpy(out.origin, entity.origin, sizeof(out.origin));
+		std::memcpy(out.angles, entity.angles, sizeof(out.angles));
+		out.model_index = entity.modelindex;
+		out.sequence = entity.sequence;
+		out.gait_sequence = entity.gaitsequence;
+		out.weapon_model = entity.weaponmodel;
+		out.team = entity.team;
+		out.move_type = entity.movetype;
+		out.effects = entity.effects;
+		out.skin = entity.skin;
+		out.body = entity.body;
+		out.render_mode = entity.rendermode;
+		out.render_amount = entity.renderamt;
+		out.render_fx = entity.renderfx;
+		out.anim_frame = entity.frame;
+		out.frame_rate = entity.framerate;
+		out.scale = entity.scale;
+	}
+
+	void fill(demo_entity_update& out, const CustomEntityState& entity)
+	{
+		out.kind = DEMO_ENTITY_CUSTOM;
+		out.entity = entity.entityNumber;
+		std::memcpy(out.origin, entity.origin, sizeof(out.origin));
+		std::memcpy(out.angles, entity.angles, sizeof(out.angles));
+		out.model_index = entity.modelindex;
+		out.sequence = entity.sequence;
+		out.skin = entity.skin;
+		out.body = entity.body;
+		out.render_mode = entity.rendermode;
+		out.render_amount = entity.renderamt;
+		out.render_fx = entity.renderfx;
+		out.anim_frame = entity.frame;
+		out.scale = entity.scale;
+	}
+
+	// Copies event into the batch; false when its array (or the text buffer) is full
+	bool store(const DemoEvent& event, demo_batch& batch)
+	{
+		switch (event.Type)
+		{
+			case DemoEventType::PlayerState: {
+				if (!batch.player_states || batch.player_states_capacity == 0)
+					return true;
+				if (batch.player_states_count == batch.player_states_capacity)
+					return false;
+
+				const PlayerState& state = event.as<PlayerState>();
+				demo_player_state& out = batch.player_states[batch.player_states_count++];
+				out.frame = event.FrameNumber;
+				out.time = event.Timestamp;
+				std::memcpy(out.position, state.position, sizeof(out.position));
+				std::memcpy(out.rotation, state.rotation, sizeof(out.rotation));
+				out.weapon_flags = state.weaponFlags;
+				out.fov = state.fov;
+				return true;
+			}
+
+			case DemoEventType::PackedPlayerEntity:
+			case DemoEventType::DeltaPackedPlayerEntity:
+			case DemoEventType::PackedCustomEntity:
+			case DemoEventType::DeltaPackedCustomEntity: {
+				if (!batch.entity_updates || batch.entity_updates_capacity == 0)
+					return true;
+				if (batch.entity_updates_count == batch.entity_updates_capacity)
+					return false;
+
+				demo_entity_update& out = batch.entity_updates[batch.entity_updates_count++];
+				std::memset(&out, 0, sizeof(out));
+				out.frame = event.FrameNumber;
+				out.time = event.Timestamp;
+				out.delta = event.Type == DemoEventType::DeltaPackedPlayerEntity || event.Type == DemoEventType::DeltaPackedCustomEntity;
+				if (event.Type == DemoEventType::PackedPlayerEntity || event.Type == DemoEventType::DeltaPackedPlayerEntity)
+					fill(out, event.as<EntityStatePlayer>());
+				else
+					fill(out, event.as<CustomEntityState>());
+				return true;
+			}
+
+			case DemoEventType::ConsoleCommand:
+			case DemoEventType::MessagePrint: {
+				if (!batch.texts || batch.texts_capacity == 0)
+					return true;
+				if (batch.texts_count == batch.texts_capacity)
+					return false;
+
+				const std::string& text = event.as<std::string>();
+				size_t room = batch.text ? batch.text_capacity - batch.text_size : 0;
+				size_t length = text.size();
+				bool truncated = false;
+				if (length > room) {
+					// a text larger than the whole buffer would never fit, it is cut instead
+					bool emptyBatch = batch.player_states_count + batch.entity_updates_count + batch.texts_count == 0;
+					if (!emptyBatch)
+						return false;
+					length = room;
+					truncated = true;
+				}
+
+				demo_text_event& out = batch.texts[batch.texts_count++];
+				out.frame = event.FrameNumber;
+				out.time = event.Timestamp;
+				out.kind = event.Type == DemoEventType::ConsoleCommand ? DEMO_TEXT_CONSOLE_COMMAND : DEMO_TEXT_PRINT;
+				out.truncated = truncated;
+				out.reserved[0] = out.reserved[1] = 0;
+				out.text_offset = static_cast<uint32_t>(batch.text_size);
+				out.text_length = static_cast<uint32_t>(length);
+				if (length > 0)
+					std::memcpy(batch.text + batch.text_size, text.data(), length);
+				batch.text_size += length;
+				return true;
+			}
+
+			default:
+				return true;
+		}
+	}
+}
+
+extern "C" {
+
+demo_parser* demo_parser_open_file(const char* path, char* error, size_t error_size)
+{
+	if (!path) {
+		copyError("No path", error, error_size);
+		return nullptr;
+	}
+
+	try {
+		return open(OpenFileByteSource(path), path, error, error_size);
+	} catch (const std::exception& ex) {
+		copyError(ex.what(), error, error_size);
+		return nullptr;
+	} catch (...) {
+		copyError("Unknown error", error, error_size);
+		return nullptr;
+	}
+}
+
+demo_parser* demo_parser_open_memory(const uint8_t* data, size_t size, char* error, size_t error_size)
+{
+	if (!data && size > 0) {
+		copyError("No data", error, error_size);
+		return nullptr;
+	}
+
+	try {
+		return open(std::make_unique<MemoryByteSource>(data, size), "buffer", error, error_size);
+	} catch (const std::exception& ex) {
+		copyError(ex.what(), error, error_size);
+		return nullptr;
+	} catch (...) {
+		copyError("Unknown error", error, error_size);
+		return nullptr;
+	}
+}
+
+void demo_parser_close(demo_parser* parser)
+{
+	delete parser;
+}
+
+int demo_parser_set_time_range(demo_parser* parser, float start, float end)
+{
+	if (!parser)
+		return -1;
+	if (parser->started) {
+		setError(*parser, "Time range set after the first read");
+		return -1;
+	}
+
+	parser->request.timeRange(start, end);
+	return 0;
+}
+
+long demo_parser_read_batch(demo_parser* parser, demo_batch* batch)
+{
+	if (!parser || !batch)
+		return -1;
+
+	batch->player_states_count = 0;
+	batch->entity_updates_count = 0;
+	batch->texts_count = 0;
+	batch->text_size = 0;
+
+	if (parser->failed || parser->finished)
+		return 0;
+
+	try {
+		if (!parser->started) {
+			parser->started = true;
+			parser->error.clear();
+			parser->parser->beginEvents(parser->request);
+		}
+
+		while (true)
+		{
+			const DemoEvent* event = parser->pending ? parser->pending : parser->parser->next();
+			parser->pending = nullptr;
+			if (!event) {
+				parser->finished = true;
+				break;
+			}
+
+			if (event->Type == DemoEventType::Header)
+				parser->mapName = event->as<DemoHeader>().mapName;
+
+			if (!store(*event, *batch)) {
+				parser->pending = event;
+				break;
+			}
+		}
+	} catch (const std::exception& ex) {
+		parser->failed = true;
+		parser->pending = nullptr;
+		setError(*parser, ex.what());
+	} catch (...) {
+		parser->failed = true;
+		parser->pending = nullptr;
+		setError(*parser, "Unknown error");
+	}
+
+	return static_cast<long>(batch->player_states_count + batch->entity_updates_count + batch->texts_count);
+}
+
+int demo_parser_status(const demo_parser* parser)
+{
+	if (!parser)
+		return DEMO_STATUS_FAILED;
+	if (parser->failed)
+		return DEMO_STATUS_FAILED;
+	if (!parser->started || !parser->finished)
+		return DEMO_STATUS_RUNNING;
+
+	switch (parser->parser->getStatus())
+	{
+		case ParseStatus::Completed:        return DEMO_STATUS_COMPLETED;
+		case ParseStatus::Stopped:          return DEMO_STATUS_STOPPED;
+		case ParseStatus::Cancelled:        return DEMO_STATUS_CANCELLED;
+		case ParseStatus::DeadlineExceeded: return DEMO_STATUS_DEADLINE_EXCEEDED;
+	}
+	return DEMO_STATUS_FAILED;
+}
+
+const char* demo_parser_error(const demo_parser* parser)
+{
+	return parser ? parser->error.c_str() : "";
+}
+
+const char* demo_parser_map_name(const demo_parser* parser)
+{
+	return parser ? parser->mapName.c_str() : "";
+}
+
+}
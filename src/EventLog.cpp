@@ -0,0 +1,803 @@
+#include <demoanalyser/EventLog.h>
+
+#include <demoanalyser/ContentHash.h>
+#include <demoanalyser/DemoParser.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+namespace demo_analyser
+{
+	namespace
+	{
+		const char Magic[4] = {'H', 'L', 'E', 'V'};
+		constexpr uint32_t Version = 1;
+
+		struct FileHeader
+		{
+			char Magic[4];
+			uint32_t Version;
+			uint64_t Layout;
+			uint64_t SourceHash;
+			uint64_t Reserved;
+		};
+
+		struct FileTrailer
+		{
+			uint64_t RecordCount;
+			uint64_t RecordsSize;
+			uint64_t StringsOffset;
+			uint64_t StringsSize;
+			uint8_t Status;
+			uint8_t Reserved[3];
+			char Magic[4];
+		};
+
+		struct RecordHeader
+		{
+			uint8_t Type;
+			uint8_t Reserved[3];
+			float Time;
+			uint32_t Frame;
+			uint32_t Size;
+		};
+
+		struct StringRef
+		{
+			uint32_t Offset;
+			uint32_t Length;
+		};
+
+		// Fixed-size stand-ins for payloads holding strings
+
+		struct DirectoryEntryRecord
+		{
+			int32_t Type;
+			StringRef Description;
+			int32_t Flags;
+			int32_t CDTrack;
+			float TrackTime;
+			int32_t FrameCount;
+			int32_t Offset;
+			int32_t FileLength;
+		};
+
+		struct DemoHeaderRecord
+		{
+			uint32_t NetworkProtocol;
+			uint32_t DemoProtocol;
+			StringRef MapName;
+			StringRef GameFolderName;
+			uint32_t MapChecksum;
+			int32_t DirectoryOffset;
+			DirectoryEntryRecord Directory[2];
+		};
+
+		struct ServerInfoRecord
+		{
+			uint32_t Protocol;
+			uint32_t SpawnCount;
+			uint32_t MapCRC;
+			uint8_t ClientDLLHash[16];
+			uint8_t MaxPlayers;
+			uint8_t PlayerIndex;
+			uint8_t IsDeathmatch;
+			uint8_t Zero;
+			StringRef GameDir;
+			StringRef Hostname;
+			StringRef MapFileName;
+			StringRef Mapcycle;
+		};
+
+		struct UserInfoRecord
+		{
+			uint32_t ClientUserID;
+			uint8_t ClientIndex;
+			uint8_t Reserved[3];
+			StringRef ClientUserInfo;
+			uint8_t ClientCDKeyHash[16];
+		};
+
+		// every MoveVars field up to skyName is a 4-byte number
+		static_assert(std::is_standard_layout<MoveVars>::value, "MoveVars fields are copied by offset");
+		constexpr size_t MoveVarsValuesSize = offsetof(MoveVars, skyName);
+
+		struct MoveVarsRecord
+		{
+			uint8_t Values[MoveVarsValuesSize];
+			StringRef SkyName;
+		};
+
+		struct DiagnosticRecord
+		{
+			int64_t FrameOffset;
+			uint32_t FrameNumber;
+			float Timestamp;
+			uint8_t FrameType;
+			uint8_t MessageId;
+			uint8_t Code;
+			uint8_t Reserved;
+			uint32_t MessageOffset;
+			uint32_t ErrorBit;
+			StringRef Error;
+		};
+
+		struct FloatRecord
+		{
+			float Value;
+		};
+
+		// followed by the ServerEvent array
+		struct ServerEventBatchRecord
+		{
+			uint32_t Dropped;
+			uint32_t Reserved;
+		};
+
+		// followed by Count TempEntity and TextSize bytes of text
+		struct TempEntityBatchRecord
+		{
+			uint32_t Count;
+			uint32_t TextSize;
+		};
+
+		// Payloads stored as is, and every record type: a build whose structs differ gets a
+		// different fingerprint and ignores the log
+		uint64_t layoutFingerprint()
+		{
+			const uint64_t sizes[] = {
+				Version, sizeof(RecordHeader), sizeof(StringRef),
+				sizeof(DemoHeaderRecord), sizeof(ServerInfoRecord), sizeof(UserInfoRecord), sizeof(MoveVarsRecord),
+				sizeof(DiagnosticRecord), sizeof(FloatRecord), sizeof(TempEntityBatchRecord), sizeof(TempEntity),
+				sizeof(ServerEventBatchRecord), sizeof(ServerEvent),
+				sizeof(PlayerState), sizeof(EventFrame), sizeof(ClientData), sizeof(Angle),
+				sizeof(EntityStatePlayer), sizeof(CustomEntityState), sizeof(WeaponData),
+				offsetof(ClientData, origin), offsetof(EntityStatePlayer, origin), offsetof(CustomEntityState, origin),
+			};
+			return HashBytes(sizes, sizeof(sizes));
+		}
+
+		constexpr size_t align8(size_t size) { return (size + 7) & ~size_t(7); }
+
+		class StringTable
+		{
+			public:
+				StringTable(const char* data_, uint64_t size_) : data(data_), size(size_) {}
+
+				bool get(StringRef ref, std::string& text) const
+				{
+					if (static_cast<uint64_t>(ref.Offset) + ref.Length > size)
+						return false;
+					text.assign(data + ref.Offset, ref.Length);
+					return true;
+				}
+
+			private:
+				const char* data;
+				uint64_t size;
+		};
+	}
+
+	EventLogWriter::EventLogWriter(const std::string& path_, uint64_t sourceHash, DemoEventSink* forward_)
+		: path(path_), temporaryPath(path_ + ".tmp"), forward(forward_)
+	{
+		out = std::make_unique<BufferedFileWriter>(temporaryPath);
+
+		FileHeader header{};
+		std::memcpy(header.Magic, Magic, sizeof(Magic));
+		header.Version = Version;
+		header.Layout = layoutFingerprint();
+		header.SourceHash = sourceHash;
+
+		out->write(reinterpret_cast<const char*>(&header), sizeof(header));
+		bytesWritten = sizeof(header);
+	}
+
+	EventLogWriter::~EventLogWriter()
+	{
+		discard();
+	}
+
+	bool EventLogWriter::finish(ParseStatus status)
+	{
+		if (done)
+			return false;
+		done = true;
+
+		static const char zeros[8] = {};
+
+		uint64_t recordsSize = bytesWritten - sizeof(FileHeader);
+		uint64_t stringsOffset = bytesWritten;
+
+		out->write(strings.data(), strings.size());
+		out->write(zeros, align8(strings.size()) - strings.size());
+
+		FileTrailer trailer{};
+		trailer.RecordCount = recordCount;
+		trailer.RecordsSize = recordsSize;
+		trailer.StringsOffset = stringsOffset;
+		trailer.StringsSize = strings.size();
+		trailer.Status = static_cast<uint8_t>(status);
+		std::memcpy(trailer.Magic, Magic, sizeof(Magic));
+		out->write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+
+		out->close();
+		if (!out->good() || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+			std::remove(temporaryPath.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	void EventLogWriter::discard()
+	{
+		if (done)
+			return;
+		done = true;
+
+		out->close();
+		std::remove(temporaryPath.c_str());
+	}
+
+	uint32_t EventLogWriter::intern(const std::string& text)
+	{
+		auto found = stringIndex.find(text);
+		if (found != stringIndex.end())
+			return found->second;
+
+		uint32_t offset = static_cast<uint32_t>(strings.size());
+		strings += text;
+		stringIndex.emplace(text, offset);
+		return offset;
+	}
+
+	template<typename Record>
+	void EventLogWriter::record(DemoEventType type, float time, uint32_t frame, const Record& payload)
+	{
+		static_assert(std::is_trivially_copyable<Record>::value, "event log payloads are copied as bytes");
+		record(type, time, frame, &payload, sizeof(Record));
+	}
+
+	void EventLogWriter::record(DemoEventType type, float time, uint32_t frame, const void* payload, size_t size)
+	{
+		static const char zeros[8] = {};
+
+		RecordHeader header{};
+		header.Type = static_cast<uint8_t>(type);
+		header.Time = time;
+		header.Frame = frame;
+		header.Size = static_cast<uint32_t>(size);
+
+		out->write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out->write(static_cast<const char*>(payload), size);
+		out->write(zeros, align8(size) - size);
+
+		bytesWritten += sizeof(header) + align8(size);
+		++recordCount;
+	}
+
+	void EventLogWriter::handle(DemoEventType type, float time, uint32_t frame, const DemoHeader& header)
+	{
+		DemoHeaderRecord record{};
+		record.NetworkProtocol = header.networkProtocol;
+		record.DemoProtocol = header.demoProtocol;
+		record.MapName = {intern(header.mapName), static_cast<uint32_t>(header.mapName.size())};
+		record.GameFolderName = {intern(header.gameFolderName), static_cast<uint32_t>(header.gameFolderName.size())};
+		record.MapChecksum = header.mapChecksum;
+		record.DirectoryOffset = header.directoryOffset;
+
+		for (int i = 0; i < 2; ++i) {
+			const DemoHeader::DemoDirectoryEntry& entry = header.demoDirectory[i];
+			DirectoryEntryRecord& target = record.Directory[i];
+			target.Type = entry.type;
+			target.Description = {intern(entry.description), static_cast<uint32_t>(entry.description.size())};
+			target.Flags = entry.flags;
+			target.CDTrack = entry.CDTrack;
+			target.TrackTime = entry.trackTime;
+			target.FrameCount = entry.frameCount;
+			target.Offset = entry.offset;
+			target.FileLength = entry.fileLength;
+		}
+
+		this->record(type, time, frame, record);
+		if (forward)
+			forward->handle(type, time, frame, header);
+	}
+
+	void EventLogWriter::handle(DemoEventType type, float time, uint32_t frame, const std::string& text)
+	{
+		record(type, time, frame, StringRef{intern(text), static_cast<uint32_t>(text.size())});
+		if (forward)
+			forward->handle(type, time, frame, text);
+	}
+
+	void EventLogWriter::handle(DemoEventType type, float time, uint32_t frame, const PlayerState& state)
+	{
+		record(type, time, frame, state);
+		if (forward)
+			forward->handle(type, time, frame, state);
+	}
+
+	void EventLogWriter::handle(DemoEventType type, float time, uint32_t frame, const EventFrame& eventFrame)
+	{
+		record(type, time, frame, eventFrame);
+		if (forward)
+			forward->handle(type, time, frame, eventFrame);
+	}
+
+	void EventLogWriter::handle(DemoEventType type, float time, uint32_t frame, float value)
+	{
+		record(type, time, frame, FloatRecord{value});
+		if (forward)
+			forward->handle(type, time, frame, value);
+	}
+
+	void EventLogWriter::handle(DemoEventType type, float time, uint32_t frame, const ClientData& clientData)
+	{
+		record(type, time, frame, clientData);
+		if (forward)
+			forward->handle(type, time, frame, clientData);
+	}
+
+	void EventLogWriter::handle(DemoEventType type, float time, uint32_t frame, const MoveVars& moveVars)
+	{
+		MoveVarsRecord record{};
+		std::memcpy(record.Values, &moveVars, MoveVarsValuesSize);
+		record.SkyName = {intern(moveVars.skyName), static_cast<uint32_t>(moveVars.skyName.size())};
+
+		this->record(type, time, frame, record);
+		if (forward)
+			forward->handle(type, time, frame, moveVars);
+	}
+
+	void EventLogWriter::handle(DemoEventType type, float time, uint32_t frame, const UpdateUserInfo& userInfo)
+	{
+		UserInfoRecord record{};
+		record.ClientUserID = userInfo.ClientUserID;
+		record.ClientIndex = userInfo.ClientIndex;
+		record.ClientUserInfo = {intern(userInfo.ClientUserInfo), static_cast<uint32_t>(userInfo.ClientUserInfo.size())};
+		std::memcpy(record.ClientCDKeyHash, userInfo.ClientCDKeyHash, sizeof(record.ClientCDKeyHash));
+
+		this->record(type, time, frame, record);
+		if (forward)
+			forward->handle(type, time, frame, userInfo);
+	}
+
+	void EventLogWriter::handle(DemoEventType type, float time, uint32_t frame, const ServerInfo& serverInfo)
+	{
+		ServerInfoRecord record{};
+		record.Protocol = serverInfo.Protocol;
+		record.SpawnCount = serverInfo.SpawnCount;
+		record.MapCRC = serverInfo.MapCRC;
+		std::memcpy(record.ClientDLLHash, serverInfo.ClientDLLHash, sizeof(record.ClientDLLHash));
+		record.MaxPlayers = serverInfo.MaxPlayers;
+		record.PlayerIndex = serverInfo.PlayerIndex;
+		record.IsDeathmatch = serverInfo.IsDeathmatch;
+		record.Zero = serverInfo.Zero;
+		record.GameDir = {intern(serverInfo.GameDir), static_cast<uint32_t>(serverInfo.GameDir.size())};
+		record.Hostname = {intern(serverInfo.Hostname), static_cast<uint32_t>(serverInfo.Hostname.size())};
+		record.MapFileName = {intern(serverInfo.MapFileName), static_cast<uint32_t>(serverInfo.MapFileName.size())};
+		record.Mapcycle = {intern(serverInfo.Mapcycle), static_cast<uint32_t>(serverInfo.Mapcycle.size())};
+
+		this->record(type, time, frame, record);
+		if (forward)
+			forward->handle(type, time, frame, serverInfo);
+	}
+
+	void EventLogWriter::handle(DemoEventType type, float time, uint32_t frame, const Angle& angle)
+	{
+		record(type, time, frame, angle);
+		if (forward)
+			forward->handle(type, time, frame, angle);
+	}
+
+	void EventLogWriter::handle(DemoEventType type, float time, uint32_t frame, const EntityStatePlayer& entity)
+	{
+		record(type, time, frame, entity);
+		if (forward)
+			forward->handle(type, time, frame, entity);
+	}
+
+	void EventLogWriter::handle(DemoEventType type, float time, uint32_t frame, const CustomEntityState& entity)
+	{
+		record(type, time, frame, entity);
+		if (forward)
+			forward->handle(type, time, frame, entity);
+	}
+
+	void EventLogWriter::handle(DemoEventType type, float time, uint32_t frame, const ParseDiagnostic& diagnostic)
+	{
+		DiagnosticRecord record{};
+		record.FrameOffset = diagnostic.frameOffset;
+		record.FrameNumber = diagnostic.frameNumber;
+		record.Timestamp = diagnostic.timestamp;
+		record.FrameType = diagnostic.frameType;
+		record.MessageId = diagnostic.messageId;
+		record.Code = static_cast<uint8_t>(diagnostic.code);
+		record.MessageOffset = diagnostic.messageOffset;
+		record.ErrorBit = diagnostic.errorBit;
+		record.Error = {intern(diagnostic.error), static_cast<uint32_t>(diagnostic.error.size())};
+
+		this->record(type, time, frame, record);
+		if (forward)
+			forward->handle(type, time, frame, diagnostic);
+	}
+
+	void EventLogWriter::handle(DemoEventType type, float time, uint32_t frame, const WeaponDataUpdate& weaponData)
+	{
+		static_assert(std::is_trivially_copyable<WeaponData>::value, "event log payloads are copied as bytes");
+		record(type, time, frame, weaponData.weapons.data(), weaponData.weapons.size() * sizeof(WeaponData));
+		if (forward)
+			forward->handle(type, time, frame, weaponData);
+	}
+
+	void EventLogWriter::handle(DemoEventType type, float time, uint32_t frame, const TempEntityBatch& tempEntities)
+	{
+		static_assert(std::is_trivially_copyable<TempEntity>::value, "event log payloads are copied as bytes");
+
+		TempEntityBatchRecord batch{};
+		batch.Count = static_cast<uint32_t>(tempEntities.entities.size());
+		batch.TextSize = static_cast<uint32_t>(tempEntities.text.size());
+
+		size_t entitiesSize = tempEntities.entities.size() * sizeof(TempEntity);
+		recordBuffer.resize(sizeof(batch) + entitiesSize + tempEntities.text.size());
+		std::memcpy(recordBuffer.data(), &batch, sizeof(batch));
+		if (entitiesSize > 0)
+			std::memcpy(recordBuffer.data() + sizeof(batch), tempEntities.entities.data(), entitiesSize);
+		if (!tempEntities.text.empty())
+			std::memcpy(recordBuffer.data() + sizeof(batch) + entitiesSize, tempEntities.text.data(), tempEntities.text.size());
+
+		record(type, time, frame, recordBuffer.data(), recordBuffer.size());
+		if (forward)
+			forward->handle(type, time, frame, tempEntities);
+	}
+
+	void EventLogWriter::handle(DemoEventType type, float time, uint32_t frame, const ServerEventBatch& serverEvents)
+	{
+		static_assert(std::is_trivially_copyable<ServerEvent>::value, "event log payloads are copied as bytes");
+
+		ServerEventBatchRecord batch{};
+		batch.Dropped = serverEvents.dropped;
+
+		size_t eventsSize = serverEvents.count * sizeof(ServerEvent);
+		recordBuffer.resize(sizeof(batch) + eventsSize);
+		std::memcpy(recordBuffer.data(), &batch, sizeof(batch));
+		if (eventsSize > 0)
+			std::memcpy(recordBuffer.data() + sizeof(batch), serverEvents.events, eventsSize);
+
+		record(type, time, frame, recordBuffer.data(), recordBuffer.size());
+		if (forward)
+			forward->handle(type, time, frame, serverEvents);
+	}
+
+	EventLog::EventLog(const std::string& path)
+		: file(path)
+	{
+		if (!file.isOpen())
+			return;
+
+		const uint8_t* data = file.data();
+		uint64_t size = static_cast<uint64_t>(file.size());
+		if (size < sizeof(FileHeader) + sizeof(FileTrailer))
+			return;
+
+		FileHeader header;
+		FileTrailer trailer;
+		std::memcpy(&header, data, sizeof(header));
+		std::memcpy(&trailer, data + size - sizeof(trailer), sizeof(trailer));
+
+		if (std::memcmp(header.Magic, Magic, sizeof(Magic)) != 0 || std::memcmp(trailer.Magic, Magic, sizeof(Magic)) != 0)
+			return;
+		if (header.Version != Version || header.Layout != layoutFingerprint())
+			return;
+
+		// records, then the padded string table, then the trailer
+		if (trailer.StringsOffset != sizeof(FileHeader) + trailer.RecordsSize ||
+			trailer.StringsOffset + align8(trailer.StringsSize) + sizeof(FileTrailer) != size)
+			return;
+
+		records = data + sizeof(FileHeader);
+		recordsEnd = records + trailer.RecordsSize;
+		strings = reinterpret_cast<const char*>(data + trailer.StringsOffset);
+		stringsSize = trailer.StringsSize;
+		recordCount = trailer.RecordCount;
+		hash = header.SourceHash;
+		parseStatus = static_cast<ParseStatus>(trailer.Status);
+
+		// walk every record before any reaches a sink, so a replay never stops part-way
+		DemoEventSink discard;
+		valid = decode(discard);
+	}
+
+	bool EventLog::replay(DemoEventSink& sink) const
+	{
+		return valid && decode(sink);
+	}
+
+	bool EventLog::decode(DemoEventSink& sink) const
+	{
+		StringTable table(strings, stringsSize);
+
+		// one reusable instance per payload type, so strings keep their capacity
+		DemoHeader demoHeader;
+		std::string text;
+		PlayerState playerState;
+		EventFrame eventFrame;
+		ClientData clientData;
+		MoveVars moveVars;
+		UpdateUserInfo userInfo;
+		ServerInfo serverInfo;
+		Angle angle;
+		EntityStatePlayer entityStatePlayer;
+		CustomEntityState customEntityState;
+		ParseDiagnostic diagnostic;
+		WeaponDataUpdate weaponData;
+		TempEntityBatch tempEntities;
+		std::vector<ServerEvent> serverEvents;
+		ServerEventBatch serverEventBatch;
+
+		const uint8_t* cursor = records;
+		uint64_t count = 0;
+		while (cursor < recordsEnd)
+		{
+			if (static_cast<size_t>(recordsEnd - cursor) < sizeof(RecordHeader))
+				return false;
+
+			RecordHeader header;
+			std::memcpy(&header, cursor, sizeof(header));
+			const uint8_t* payload = cursor + sizeof(header);
+
+			if (static_cast<uint64_t>(recordsEnd - payload) < align8(header.Size))
+				return false;
+			cursor = payload + align8(header.Size);
+			++count;
+
+			// reads the payload as Record, if it has Record's size
+			auto load = [&](auto& record) {
+				if (header.Size != sizeof(record))
+					return false;
+				std::memcpy(&record, payload, sizeof(record));
+				return true;
+			};
+
+			DemoEventType type = static_cast<DemoEventType>(header.Type);
+			switch (type)
+			{
+				case DemoEventType::Header:
+				case DemoEventType::Directory: {
+					DemoHeaderRecord record;
+					if (!load(record) || !table.get(record.MapName, demoHeader.mapName) || !table.get(record.GameFolderName, demoHeader.gameFolderName))
+						return false;
+					demoHeader.networkProtocol = record.NetworkProtocol;
+					demoHeader.demoProtocol = record.DemoProtocol;
+					demoHeader.mapChecksum = record.MapChecksum;
+					demoHeader.directoryOffset = record.DirectoryOffset;
+					for (int i = 0; i < 2; ++i) {
+						const DirectoryEntryRecord& entry = record.Directory[i];
+						DemoHeader::DemoDirectoryEntry& target = demoHeader.demoDirectory[i];
+						if (!table.get(entry.Description, target.description))
+							return false;
+						target.type = entry.Type;
+						target.flags = entry.Flags;
+						target.CDTrack = entry.CDTrack;
+						target.trackTime = entry.TrackTime;
+						target.frameCount = entry.FrameCount;
+						target.offset = entry.Offset;
+						target.fileLength = entry.FileLength;
+					}
+					sink.handle(type, header.Time, header.Frame, demoHeader);
+					break;
+				}
+
+				case DemoEventType::ConsoleCommand:
+				case DemoEventType::MessagePrint: {
+					StringRef record;
+					if (!load(record) || !table.get(record, text))
+						return false;
+					sink.handle(type, header.Time, header.Frame, text);
+					break;
+				}
+
+				case DemoEventType::PlayerState:
+					if (!load(playerState))
+						return false;
+					sink.handle(type, header.Time, header.Frame, playerState);
+					break;
+
+				case DemoEventType::EventFrame:
+					if (!load(eventFrame))
+						return false;
+					sink.handle(type, header.Time, header.Frame, eventFrame);
+					break;
+
+				case DemoEventType::TimeTick: {
+					FloatRecord record;
+					if (!load(record))
+						return false;
+					sink.handle(type, header.Time, header.Frame, record.Value);
+					break;
+				}
+
+				case DemoEventType::ClientData:
+					if (!load(clientData))
+						return false;
+					sink.handle(type, header.Time, header.Frame, clientData);
+					break;
+
+				case DemoEventType::NewMoveVars: {
+					MoveVarsRecord record;
+					if (!load(record) || !table.get(record.SkyName, moveVars.skyName))
+						return false;
+					std::memcpy(static_cast<void*>(&moveVars), record.Values, MoveVarsValuesSize);
+					sink.handle(type, header.Time, header.Frame, moveVars);
+					break;
+				}
+
+				case DemoEventType::UpdateUserInfo: {
+					UserInfoRecord record;
+					if (!load(record) || !table.get(record.ClientUserInfo, userInfo.ClientUserInfo))
+						return false;
+					userInfo.ClientUserID = record.ClientUserID;
+					userInfo.ClientIndex = record.ClientIndex;
+					std::memcpy(userInfo.ClientCDKeyHash, record.ClientCDKeyHash, sizeof(record.ClientCDKeyHash));
+					sink.handle(type, header.Time, header.Frame, userInfo);
+					break;
+				}
+
+				case DemoEventType::ServerInfo: {
+					ServerInfoRecord record;
+					if (!load(record) || !table.get(record.GameDir, serverInfo.GameDir) || !table.get(record.Hostname, serverInfo.Hostname) ||
+						!table.get(record.MapFileName, serverInfo.MapFileName) || !table.get(record.Mapcycle, serverInfo.Mapcycle))
+						return false;
+					serverInfo.Protocol = record.Protocol;
+					serverInfo.SpawnCount = record.SpawnCount;
+					serverInfo.MapCRC = record.MapCRC;
+					std::memcpy(serverInfo.ClientDLLHash, record.ClientDLLHash, sizeof(record.ClientDLLHash));
+					serverInfo.MaxPlayers = record.MaxPlayers;
+					serverInfo.PlayerIndex = record.PlayerIndex;
+					serverInfo.IsDeathmatch = record.IsDeathmatch;
+					serverInfo.Zero = record.Zero;
+					sink.handle(type, header.Time, header.Frame, serverInfo);
+					break;
+				}
+
+				case DemoEventType::SetAngle:
+					if (!load(angle))
+						return false;
+					sink.handle(type, header.Time, header.Frame, angle);
+					break;
+
+				case DemoEventType::PackedPlayerEntity:
+				case DemoEventType::DeltaPackedPlayerEntity:
+					if (!load(entityStatePlayer))
+						return false;
+					sink.handle(type, header.Time, header.Frame, entityStatePlayer);
+					break;
+
+				case DemoEventType::PackedCustomEntity:
+				case DemoEventType::DeltaPackedCustomEntity:
+					if (!load(customEntityState))
+						return false;
+					sink.handle(type, header.Time, header.Frame, customEntityState);
+					break;
+
+				case DemoEventType::Diagnostic: {
+					DiagnosticRecord record;
+					if (!load(record) || !table.get(record.Error, diagnostic.error))
+						return false;
+					diagnostic.frameOffset = record.FrameOffset;
+					diagnostic.frameNumber = record.FrameNumber;
+					diagnostic.timestamp = record.Timestamp;
+					diagnostic.frameType = record.FrameType;
+					diagnostic.messageId = record.MessageId;
+					diagnostic.code = static_cast<DecodeError>(record.Code);
+					diagnostic.messageOffset = record.MessageOffset;
+					diagnostic.errorBit = record.ErrorBit;
+					sink.handle(type, header.Time, header.Frame, diagnostic);
+					break;
+				}
+
+				case DemoEventType::WeaponData:
+					if (header.Size % sizeof(WeaponData) != 0)
+						return false;
+					weaponData.weapons.resize(header.Size / sizeof(WeaponData));
+					if (header.Size > 0)
+						std::memcpy(weaponData.weapons.data(), payload, header.Size);
+					sink.handle(type, header.Time, header.Frame, weaponData);
+					break;
+
+				case DemoEventType::TempEntity:
+				{
+					TempEntityBatchRecord batch;
+					if (header.Size < sizeof(batch))
+						return false;
+					std::memcpy(&batch, payload, sizeof(batch));
+
+					size_t entitiesSize = static_cast<size_t>(batch.Count) * sizeof(TempEntity);
+					if (header.Size != sizeof(batch) + entitiesSize + batch.TextSize)
+						return false;
+
+					tempEntities.entities.resize(batch.Count);
+					if (entitiesSize > 0)
+						std::memcpy(tempEntities.entities.data(), payload + sizeof(batch), entitiesSize);
+					tempEntities.text.assign(reinterpret_cast<const char*>(payload) + sizeof(batch) + entitiesSize, batch.TextSize);
+					sink.handle(type, header.Time, header.Frame, tempEntities);
+					break;
+				}
+
+				case DemoEventType::ServerEvents:
+				{
+					ServerEventBatchRecord batch;
+					if (header.Size < sizeof(batch) || (header.Size - sizeof(batch)) % sizeof(ServerEvent) != 0)
+						return false;
+					std::memcpy(&batch, payload, sizeof(batch));
+
+					serverEvents.resize((header.Size - sizeof(batch)) / sizeof(ServerEvent));
+					if (!serverEvents.empty())
+						std::memcpy(serverEvents.data(), payload + sizeof(batch), header.Size - sizeof(batch));
+
+					serverEventBatch.events = serverEvents.data();
+					serverEventBatch.count = static_cast<uint32_t>(serverEvents.size());
+					serverEventBatch.dropped = batch.Dropped;
+					sink.handle(type, header.Time, header.Frame, serverEventBatch);
+					break;
+				}
+
+				default:
+					return false;
+			}
+		}
+
+		return count == recordCount;
+	}
+
+	std::string EventLogPath(const std::string& demoPath)
+	{
+		return demoPath + ".evlog";
+	}
+
+	ParseStatus ParseWithEventLog(const std::string& demoPath, DemoEventSink* sink)
+	{
+		CallbackEventSink callbacks;
+		DemoEventSink& target = sink ? *sink : callbacks;
+
+		uint64_t hash = 0;
+		bool hashed = HashFile(demoPath, hash);
+		std::string logPath = EventLogPath(demoPath);
+
+		if (hashed) {
+			{
+				EventLog log(logPath);
+				if (log.isValid() && log.sourceHash() == hash) {
+					if (!log.replay(target))
+						throw std::runtime_error("Corrupt event log " + logPath);
+					return log.status();
+				}
+			}
+
+			// stale or corrupt: drop it so a failed parse below does not leave it to be retried
+			std::remove(logPath.c_str());
+		}
+
+		DemoParser parser(OpenFileByteSource(demoPath));
+
+		if (!hashed) {
+			parser.setEventSink(&target);
+			return parser.parseDemo();
+		}
+
+		EventLogWriter writer(logPath, hash, &target);
+		parser.setEventSink(&writer);
+
+		ParseStatus status = parser.parseDemo();
+		if (status == ParseStatus::Completed)
+			writer.finish(status);
+		else
+			writer.discard();
+
+		return status;
+	}
+}
@@ -0,0 +1,85 @@
+#include <demoanalyser/GzipByteSource.h>
+
+#include <zlib.h>
+
+namespace demo_analyser
+{
+
+	GzipByteSource::GzipByteSource(std::unique_ptr<ByteSource> compressed_)
+		: compressed(std::move(compressed_)), zstream(std::make_unique<z_stream_s>()), input(InputChunkSize)
+	{
+		// 16 + MAX_WBITS: expect a gzip header and trailer rather than a raw zlib stream
+		if (!compressed || !compressed->good() || inflateInit2(zstream.get(), 16 + MAX_WBITS) != Z_OK) {
+			zstream.reset();
+			ok = false;
+		}
+	}
+
+	GzipByteSource::~GzipByteSource()
+	{
+		if (zstream)
+			inflateEnd(zstream.get());
+	}
+
+	bool GzipByteSource::looksCompressed(ByteSource& source)
+	{
+		uint8_t magic[2] = {};
+		int64_t start = source.tell();
+
+		size_t count = source.read(magic, sizeof(magic));
+		source.seek(start, std::ios::beg);
+
+		return count == sizeof(magic) && magic[0] == 0x1f && magic[1] == 0x8b;
+	}
+
+	size_t GzipByteSource::fill(uint8_t* dst, size_t size)
+	{
+		if (!zstream || inflateError)
+			return 0;
+
+		z_stream_s& z = *zstream;
+		z.next_out = dst;
+		z.avail_out = static_cast<uInt>(size);
+
+		while (z.avail_out > 0)
+		{
+			if (z.avail_in == 0 && !inputEnded) {
+				size_t count = compressed->read(input.data(), input.size());
+				if (count < input.size())
+					inputEnded = true;
+
+				z.next_in = input.data();
+				z.avail_in = static_cast<uInt>(count);
+			}
+
+			if (streamEnded) {
+				// concatenated gzip members decode as one stream
+				if (z.avail_in == 0)
+					break;
+				if (inflateReset(&z) != Z_OK) {
+					inflateError = true;
+					break;
+				}
+				streamEnded = false;
+			}
+
+			int result = inflate(&z, Z_NO_FLUSH);
+
+			if (result == Z_STREAM_END) {
+				streamEnded = true;
+				continue;
+			}
+
+			if (result == Z_BUF_ERROR && z.avail_in == 0 && inputEnded)
+				break; // truncated archive, hand out what we have
+
+			if (result != Z_OK && result != Z_BUF_ERROR) {
+				inflateError = true;
+				break;
+			}
+		}
+
+		return size - z.avail_out;
+	}
+
+}
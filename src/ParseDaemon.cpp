@@ -0,0 +1,549 @@
+#include <demoanalyser/ParseDaemon.h>
+
+#include <demoanalyser/ArrowExporter.h>
+#include <demoanalyser/ContentHash.h>
+#include <demoanalyser/DemoParser.h>
+#include <demoanalyser/TextExporter.h>
+#include <demoanalyser/TrajectoryWriter.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace demo_analyser
+{
+	namespace
+	{
+		constexpr size_t MaxRequestSize = 64 * 1024;
+		constexpr int RequestTimeoutSeconds = 5;
+
+		// Event counts and the headline facts of a parse
+		class SummarySink : public DemoEventSink
+		{
+			public:
+				void handle(DemoEventType type, float time, uint32_t frame, const DemoHeader& header) override
+				{
+					mapName = header.mapName;
+					count(type, time, frame);
+				}
+
+				void handle(DemoEventType type, float time, uint32_t frame, const std::string&) override { count(type, time, frame); }
+				void handle(DemoEventType type, float time, uint32_t frame, const PlayerState&) override { count(type, time, frame); }
+				void handle(DemoEventType type, float time, uint32_t frame, const EventFrame&) override { count(type, time, frame); }
+				void handle(DemoEventType type, float time, uint32_t frame, float) override { count(type, time, frame); }
+				void handle(DemoEventType type, float time, uint32_t frame, const ClientData&) override { count(type, time, frame); }
+				void handle(DemoEventType type, float time, uint32_t frame, const MoveVars&) override { count(type, time, frame); }
+				void handle(DemoEventType type, float time, uint32_t frame, const UpdateUserInfo&) override { count(type, time, frame); }
+				void handle(DemoEventType type, float time, uint32_t frame, const ServerInfo&) override { count(type, time, frame); }
+				void handle(DemoEventType type, float time, uint32_t frame, const Angle&) override { count(type, time, frame); }
+				void handle(DemoEventType type, float time, uint32_t frame, const EntityStatePlayer&) override { count(type, time, frame); }
+				void handle(DemoEventType type, float time, uint32_t frame, const CustomEntityState&) override { count(type, time, frame); }
+				void handle(DemoEventType type, float time, uint32_t frame, const ParseDiagnostic&) override { count(type, time, frame); }
+				void handle(DemoEventType type, float time, uint32_t frame, const WeaponDataUpdate&) override { count(type, time, frame); }
+				void handle(DemoEventType type, float time, uint32_t frame, const TempEntityBatch&) override { count(type, time, frame); }
+				void handle(DemoEventType type, float time, uint32_t frame, const ServerEventBatch&) override { count(type, time, frame); }
+
+				void write(std::ostringstream& out) const
+				{
+					out << "map=" << mapName << "\n";
+					out << "last_frame=" << lastFrame << "\n";
+					out << "last_time=" << lastTime << "\n";
+					for (size_t i = 0; i < counts.size(); ++i)
+						if (counts[i] > 0)
+							out << "events." << DemoEventTypeName(static_cast<DemoEventType>(i)) << "=" << counts[i] << "\n";
+				}
+
+			private:
+				void count(DemoEventType type, float time, uint32_t frame)
+				{
+					++counts[static_cast<size_t>(type)];
+					lastTime = std::max(lastTime, time);
+					lastFrame = std::max(lastFrame, frame);
+				}
+
+				std::string mapName;
+				std::vector<uint64_t> counts = std::vector<uint64_t>(256);
+				float lastTime = 0.0f;
+				uint32_t lastFrame = 0;
+		};
+
+		std::vector<std::string> split(const std::string& text, char separator)
+		{
+			std::vector<std::string> parts;
+			size_t start = 0;
+			while (true) {
+				size_t end = text.find(separator, start);
+				parts.push_back(text.substr(start, end - start));
+				if (end == std::string::npos)
+					return parts;
+				start = end + 1;
+			}
+		}
+
+		std::string defaultPrefix(const std::string& path)
+		{
+			std::string prefix = path;
+			size_t dot = prefix.find_last_of('.');
+			size_t slash = prefix.find_last_of('/');
+			if (dot != std::string::npos && (slash == std::string::npos || dot > slash))
+				prefix.erase(dot);
+			return prefix + "_";
+		}
+
+		bool fileExists(const std::string& path)
+		{
+			struct stat st{};
+			return ::stat(path.c_str(), &st) == 0;
+		}
+
+		bool sendAll(int fd, const std::string& data)
+		{
+			size_t sent = 0;
+			while (sent < data.size()) {
+				ssize_t count = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+				if (count < 0 && errno == EINTR)
+					continue;
+				if (count <= 0)
+					return false;
+				sent += static_cast<size_t>(count);
+			}
+			return true;
+		}
+
+		bool fillAddress(const std::string& path, sockaddr_un& address)
+		{
+			std::memset(&address, 0, sizeof(address));
+			address.sun_family = AF_UNIX;
+			if (path.size() >= sizeof(address.sun_path))
+				return false;
+			std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+			return true;
+		}
+	}
+
+	ParseDaemon::ParseDaemon(ParseDaemonOptions options_)
+		: options(std::move(options_))
+	{
+		if (options.Workers == 0)
+			options.Workers = std::max(1u, std::thread::hardware_concurrency());
+		options.CacheEntries = std::max<size_t>(options.CacheEntries, 1);
+	}
+
+	ParseDaemon::~ParseDaemon()
+	{
+		stop();
+	}
+
+	bool ParseDaemon::start()
+	{
+		if (running)
+			return true;
+
+		sockaddr_un address;
+		if (!fillAddress(options.SocketPath, address)) {
+			lastError = "Socket path too long";
+			return false;
+		}
+
+		listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (listener < 0) {
+			lastError = std::strerror(errno);
+			return false;
+		}
+
+		// a socket file left behind by an earlier run
+		::unlink(options.SocketPath.c_str());
+
+		if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listener, 64) != 0) {
+			lastError = std::strerror(errno);
+			::close(listener);
+			listener = -1;
+			return false;
+		}
+
+		running = true;
+		stopping = false;
+
+		for (unsigned i = 0; i < options.Workers; ++i)
+			workers.emplace_back(&ParseDaemon::workerLoop, this);
+		acceptor = std::thread(&ParseDaemon::acceptLoop, this);
+
+		return true;
+	}
+
+	void ParseDaemon::stop()
+	{
+		if (!running)
+			return;
+		running = false;
+
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			stopping = true;
+		}
+		queueReady.notify_all();
+
+		// wakes the acceptor out of accept()
+		::shutdown(listener, SHUT_RDWR);
+		acceptor.join();
+		::close(listener);
+		listener = -1;
+
+		for (std::thread& worker : workers)
+			worker.join();
+		workers.clear();
+
+		// connections nobody got to
+		for (int connection : connections)
+			::close(connection);
+		connections.clear();
+
+		::unlink(options.SocketPath.c_str());
+	}
+
+	void ParseDaemon::acceptLoop()
+	{
+		while (true)
+		{
+			int connection = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+			if (connection < 0) {
+				if (errno == EINTR || errno == ECONNABORTED)
+					continue;
+				return;  // listener shut down
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(queueMutex);
+				if (stopping) {
+					::close(connection);
+					return;
+				}
+				connections.push_back(connection);
+			}
+			queueReady.notify_one();
+		}
+	}
+
+	void ParseDaemon::workerLoop()
+	{
+		while (true)
+		{
+			int connection = -1;
+			{
+				std::unique_lock<std::mutex> lock(queueMutex);
+				queueReady.wait(lock, [this] { return stopping || !connections.empty(); });
+				if (stopping)
+					return;
+				connection = connections.front();
+				connections.pop_front();
+			}
+
+			serve(connection);
+			::close(connection);
+		}
+	}
+
+	void ParseDaemon::serve(int connection)
+	{
+		// a client that never finishes its line does not hold a worker forever
+		timeval timeout{RequestTimeoutSeconds, 0};
+		::setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+		std::string line;
+		char buffer[4096];
+		while (line.find('\n') == std::string::npos && line.size() < MaxRequestSize) {
+			ssize_t count = ::recv(connection, buffer, sizeof(buffer), 0);
+			if (count < 0 && errno == EINTR)
+				continue;
+			if (count <= 0)
+				break;
+			line.append(buffer, static_cast<size_t>(count));
+		}
+
+		size_t end = line.find('\n');
+		if (end == std::string::npos) {
+			sendAll(connection, "ERROR Incomplete request\n");
+			return;
+		}
+		line.erase(end);
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+
+		sendAll(connection, handleRequest(line));
+	}
+
+	std::string ParseDaemon::handleRequest(const std::string& line)
+	{
+		std::vector<std::string> parts = split(line, '\t');
+		const std::string& verb = parts[0];
+
+		if (verb == "STATS") {
+			std::lock_guard<std::mutex> lock(cacheMutex);
+			std::ostringstream out;
+			out << "OK\n";
+			out << "workers=" << options.Workers << "\n";
+			out << "cache_entries=" << cache.size() << "\n";
+			out << "cache_capacity=" << options.CacheEntries << "\n";
+			out << "cache_hits=" << hits << "\n";
+			out << "cache_misses=" << misses << "\n";
+			return out.str();
+		}
+
+		if (verb != "PARSE")
+			return "ERROR Unknown request\n";
+
+		std::unordered_map<std::string, std::string> fields;
+		for (size_t i = 1; i < parts.size(); ++i) {
+			size_t equals = parts[i].find('=');
+			if (equals == std::string::npos)
+				return "ERROR Malformed field " + parts[i] + "\n";
+			fields[parts[i].substr(0, equals)] = parts[i].substr(equals + 1);
+		}
+
+		if (fields["path"].empty())
+			return "ERROR Missing path\n";
+
+		try {
+			return runParse(fields);
+		} catch (const std::exception& ex) {
+			return std::string("ERROR ") + ex.what() + "\n";
+		}
+	}
+
+	std::string ParseDaemon::runParse(const std::unordered_map<std::string, std::string>& fields)
+	{
+		auto field = [&](const char* name) {
+			auto found = fields.find(name);
+			return found == fields.end() ? std::string() : found->second;
+		};
+
+		std::string path = field("path");
+		std::string prefix = field("prefix");
+		if (prefix.empty())
+			prefix = defaultPrefix(path);
+
+		ParseRequest request;
+		std::string start = field("start"), end = field("end");
+		if (!start.empty() || !end.empty())
+			request.timeRange(start.empty() ? request.StartTime : std::stof(start), end.empty() ? request.EndTime : std::stof(end));
+
+		std::vector<std::string> outputs = split(field("outputs").empty() ? "summary" : field("outputs"), ',');
+		std::sort(outputs.begin(), outputs.end());
+		outputs.erase(std::unique(outputs.begin(), outputs.end()), outputs.end());
+
+		for (const std::string& output : outputs)
+			if (output != "summary" && output != "ndjson" && output != "csv" && output != "arrow" && output != "trajectory")
+				throw std::runtime_error("Unknown output " + output);
+
+		uint64_t hash = 0;
+		if (!contentHash(path, hash))
+			throw std::runtime_error("Failed to read " + path);
+
+		char hashText[17];
+		std::snprintf(hashText, sizeof(hashText), "%016llx", static_cast<unsigned long long>(hash));
+
+		std::ostringstream keyStream;
+		keyStream << hashText << '\t' << request.StartTime << '\t' << request.EndTime << '\t' << prefix;
+		for (const std::string& output : outputs)
+			keyStream << '\t' << output;
+		std::string key = keyStream.str();
+
+		std::string response;
+		if (findCached(key, response))
+			return "OK\ncached=1\n" + response;
+
+		// from here on this job owns the key until it is stored or abandoned
+		struct InFlight
+		{
+			ParseDaemon& daemon;
+			const std::string& key;
+			~InFlight()
+			{
+				{
+					std::lock_guard<std::mutex> lock(daemon.cacheMutex);
+					daemon.inFlight.erase(key);
+				}
+				daemon.jobDone.notify_all();
+			}
+		} inFlight{*this, key};
+
+		FanOutEventSink sinks;
+		SummarySink summary;
+		std::unique_ptr<TextExporter> ndjson, csv;
+		std::unique_ptr<ArrowExporter> arrow;
+		std::unique_ptr<TrajectoryWriter> trajectory;
+		std::vector<std::string> files;
+
+		for (const std::string& output : outputs) {
+			if (output == "summary") {
+				sinks.add(&summary);
+			} else if (output == "ndjson") {
+				ndjson = std::make_unique<TextExporter>(prefix, TextFormat::NDJson);
+				sinks.add(ndjson.get());
+				files.insert(files.end(), ndjson->files().begin(), ndjson->files().end());
+			} else if (output == "csv") {
+				csv = std::make_unique<TextExporter>(prefix, TextFormat::Csv);
+				sinks.add(csv.get());
+				files.insert(files.end(), csv->files().begin(), csv->files().end());
+			} else if (output == "arrow") {
+				arrow = std::make_unique<ArrowExporter>(prefix);
+				sinks.add(arrow.get());
+				files.insert(files.end(), arrow->files().begin(), arrow->files().end());
+			} else if (output == "trajectory") {
+				trajectory = std::make_unique<TrajectoryWriter>(prefix + "trajectories.hltj");
+				sinks.add(trajectory.get());
+				files.push_back(prefix + "trajectories.hltj");
+			}
+		}
+
+		DemoParser parser(OpenFileByteSource(path));
+		parser.setEventSink(&sinks);
+		ParseStatus status = parser.parseDemo(request);
+
+		bool written = true;
+		if (ndjson) { ndjson->finish(); written &= ndjson->good(); }
+		if (csv) { csv->finish(); written &= csv->good(); }
+		if (arrow) { arrow->finish(); written &= arrow->good(); }
+		if (trajectory) { trajectory->finish(); written &= trajectory->good(); }
+		if (!written)
+			throw std::runtime_error("Failed to write outputs to " + prefix);
+
+		std::ostringstream out;
+		out << "status=" << ParseStatusName(status) << "\n";
+		out << "hash=" << hashText << "\n";
+		if (std::binary_search(outputs.begin(), outputs.end(), "summary"))
+			summary.write(out);
+		for (const std::string& file : files)
+			out << "file=" << file << "\n";
+
+		response = out.str();
+		if (status == ParseStatus::Completed)
+			storeCached({key, response, files});
+
+		return "OK\ncached=0\n" + response;
+	}
+
+	bool ParseDaemon::contentHash(const std::string& path, uint64_t& hash)
+	{
+		struct stat st{};
+		if (::stat(path.c_str(), &st) != 0)
+			return false;
+
+		int64_t modified = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+
+		{
+			std::lock_guard<std::mutex> lock(hashMutex);
+			auto found = fileHashes.find(path);
+			if (found != fileHashes.end() && found->second.Size == st.st_size && found->second.ModifiedNanoseconds == modified) {
+				hash = found->second.Hash;
+				return true;
+			}
+		}
+
+		if (!HashFile(path, hash))
+			return false;
+
+		std::lock_guard<std::mutex> lock(hashMutex);
+		fileHashes[path] = {static_cast<int64_t>(st.st_size), modified, hash};
+		return true;
+	}
+
+	bool ParseDaemon::findCached(const std::string& key, std::string& response)
+	{
+		std::unique_lock<std::mutex> lock(cacheMutex);
+
+		// the same job is running on another worker: wait for its result instead of
+		// writing the same output files twice
+		jobDone.wait(lock, [&] { return inFlight.count(key) == 0; });
+
+		auto found = cacheIndex.find(key);
+		if (found != cacheIndex.end()) {
+			const CachedResult& result = *found->second;
+			bool intact = std::all_of(result.Files.begin(), result.Files.end(), fileExists);
+
+			if (intact) {
+				cache.splice(cache.begin(), cache, found->second);
+				response = result.Response;
+				++hits;
+				return true;
+			}
+
+			cache.erase(found->second);
+			cacheIndex.erase(found);
+		}
+
+		++misses;
+		inFlight.insert(key);
+		return false;
+	}
+
+	void ParseDaemon::storeCached(CachedResult result)
+	{
+		std::lock_guard<std::mutex> lock(cacheMutex);
+
+		auto found = cacheIndex.find(result.Key);
+		if (found != cacheIndex.end()) {
+			cache.erase(found->second);
+			cacheIndex.erase(found);
+		}
+
+		cache.push_front(std::move(result));
+		cacheIndex[cache.front().Key] = cache.begin();
+
+		while (cache.size() > options.CacheEntries) {
+			cacheIndex.erase(cache.back().Key);
+			cache.pop_back();
+		}
+	}
+
+	std::string SendDaemonRequest(const std::string& socketPath, const std::string& request)
+	{
+		sockaddr_un address;
+		if (!fillAddress(socketPath, address))
+			throw std::runtime_error("Socket path too long");
+
+		int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (fd < 0)
+			throw std::runtime_error(std::strerror(errno));
+
+		if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+			std::string reason = std::strerror(errno);
+			::close(fd);
+			throw std::runtime_error("Cannot reach daemon at " + socketPath + ": " + reason);
+		}
+
+		std::string line = request;
+		if (line.empty() || line.back() != '\n')
+			line += '\n';
+
+		if (!sendAll(fd, line)) {
+			::close(fd);
+			throw std::runtime_error("Failed to send request");
+		}
+
+		std::string response;
+		char buffer[4096];
+		while (true) {
+			ssize_t count = ::recv(fd, buffer, sizeof(buffer), 0);
+			if (count < 0 && errno == EINTR)
+				continue;
+			if (count <= 0)
+				break;
+			response.append(buffer, static_cast<size_t>(count));
+		}
+
+		::close(fd);
+		return response;
+	}
+}
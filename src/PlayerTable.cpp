@@ -0,0 +1,186 @@
+#include <demoanalyser/PlayerTable.h>
+
+#include <charconv>
+#include <cstring>
+
+namespace demo_analyser
+{
+	std::string_view PlayerSlot::get(std::string_view key) const
+	{
+		for (const auto& field : Fields)
+			if (field.first == key)
+				return field.second;
+		return {};
+	}
+
+	PlayerSlot& PlayerSlot::operator=(const PlayerSlot& other)
+	{
+		if (this == &other)
+			return *this;
+
+		Active = other.Active;
+		Slot = other.Slot;
+		UserID = other.UserID;
+		SteamID = other.SteamID;
+		std::memcpy(CDKeyHash, other.CDKeyHash, sizeof(CDKeyHash));
+		UserInfo = other.UserInfo;
+		Fields = other.Fields;
+		Name = other.Name;
+		Team = other.Team;
+		Model = other.Model;
+		rebase(other.UserInfo.data());
+		return *this;
+	}
+
+	PlayerSlot& PlayerSlot::operator=(PlayerSlot&& other) noexcept
+	{
+		if (this == &other)
+			return *this;
+
+		// a long string keeps its buffer when moved; a short one stored inline does not
+		const char* from = other.UserInfo.data();
+		Active = other.Active;
+		Slot = other.Slot;
+		UserID = other.UserID;
+		SteamID = other.SteamID;
+		std::memcpy(CDKeyHash, other.CDKeyHash, sizeof(CDKeyHash));
+		UserInfo = std::move(other.UserInfo);
+		Fields = std::move(other.Fields);
+		Name = other.Name;
+		Team = other.Team;
+		Model = other.Model;
+		rebase(from);
+		return *this;
+	}
+
+	void PlayerSlot::rebase(const char* from)
+	{
+		if (from == UserInfo.data())
+			return;
+
+		auto move = [&](std::string_view& view) {
+			if (view.data())
+				view = std::string_view(UserInfo.data() + (view.data() - from), view.size());
+		};
+
+		for (auto& field : Fields) {
+			move(field.first);
+			move(field.second);
+		}
+		move(Name);
+		move(Team);
+		move(Model);
+	}
+
+	void PlayerTable::reset(size_t maxClients)
+	{
+		table.clear();
+		table.resize(maxClients);
+		for (size_t i = 0; i < table.size(); ++i)
+			table[i].Slot = static_cast<uint8_t>(i);
+
+		userIDs.clear();
+		steamIDs.clear();
+	}
+
+	const PlayerSlot& PlayerTable::update(uint8_t slot, uint32_t userID, const std::string& userInfo, const uint8_t cdKeyHash[16])
+	{
+		if (slot >= table.size()) {
+			size_t previous = table.size();
+			table.resize(slot + 1);
+			for (size_t i = previous; i < table.size(); ++i)
+				table[i].Slot = static_cast<uint8_t>(i);
+		}
+
+		PlayerSlot& player = table[slot];
+		std::memcpy(player.CDKeyHash, cdKeyHash, sizeof(player.CDKeyHash));
+
+		// the server resends unchanged userinfo often (full client updates)
+		if (player.Active == !userInfo.empty() && player.UserID == userID && player.UserInfo == userInfo)
+			return player;
+
+		unindex(player);
+
+		player.UserID = userID;
+		player.UserInfo.assign(userInfo);
+		player.Active = !userInfo.empty();
+		tokenize(player);
+
+		if (player.Active) {
+			userIDs[userID] = slot;
+			if (player.SteamID != 0)
+				steamIDs[player.SteamID] = slot;
+		}
+
+		return player;
+	}
+
+	const PlayerSlot* PlayerTable::bySlot(size_t slot) const
+	{
+		return slot < table.size() && table[slot].Active ? &table[slot] : nullptr;
+	}
+
+	const PlayerSlot* PlayerTable::byUserID(uint32_t userID) const
+	{
+		auto found = userIDs.find(userID);
+		return found == userIDs.end() ? nullptr : &table[found->second];
+	}
+
+	const PlayerSlot* PlayerTable::bySteamID(uint64_t steamID) const
+	{
+		auto found = steamIDs.find(steamID);
+		return found == steamIDs.end() ? nullptr : &table[found->second];
+	}
+
+	void PlayerTable::unindex(const PlayerSlot& player)
+	{
+		if (!player.Active)
+			return;
+
+		auto user = userIDs.find(player.UserID);
+		if (user != userIDs.end() && user->second == player.Slot)
+			userIDs.erase(user);
+
+		auto steam = steamIDs.find(player.SteamID);
+		if (steam != steamIDs.end() && steam->second == player.Slot)
+			steamIDs.erase(steam);
+	}
+
+	// "\name\Player\model\gsg9\*sid\76561197960287930" -> (name, Player), (model, gsg9), ...
+	void PlayerTable::tokenize(PlayerSlot& player)
+	{
+		player.Fields.clear();
+		player.Name = player.Team = player.Model = {};
+		player.SteamID = 0;
+
+		std::string_view info = player.UserInfo;
+		if (!info.empty() && info.front() == '\\')
+			info.remove_prefix(1);
+
+		while (!info.empty()) {
+			size_t keyEnd = info.find('\\');
+			std::string_view key = info.substr(0, keyEnd);
+			std::string_view value;
+
+			if (keyEnd == std::string_view::npos) {
+				info = {};
+			} else {
+				info.remove_prefix(keyEnd + 1);
+				size_t valueEnd = info.find('\\');
+				value = info.substr(0, valueEnd);
+				info.remove_prefix(valueEnd == std::string_view::npos ? info.size() : valueEnd + 1);
+			}
+
+			player.Fields.emplace_back(key, value);
+
+			if (key == "name")
+				player.Name = value;
+			else if (key == "team")
+				player.Team = value;
+			else if (key == "model")
+				player.Model = value;
+			else if (key == "*sid")
+				std::from_chars(value.data(), value.data() + value.size(), player.SteamID);
+		}
+	}
+}
@@ -0,0 +1,152 @@
+#include <demoanalyser/ReadAheadByteSource.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace demo_analyser
+{
+
+	ReadAheadByteSource::ReadAheadByteSource(std::unique_ptr<ByteSource> inner_, size_t chunkSize_, size_t depth_)
+		: BufferedByteSource(std::max<size_t>(chunkSize_, DefaultChunkSize)),
+		  inner(std::move(inner_)), chunkSize(std::max<size_t>(chunkSize_, 1)), depth(std::max<size_t>(depth_, 1))
+	{
+		if (!inner || !inner->good()) {
+			ok = false;
+			return;
+		}
+
+		resetBuffer(inner->tell());
+		start();
+	}
+
+	ReadAheadByteSource::~ReadAheadByteSource()
+	{
+		stop();
+	}
+
+	void ReadAheadByteSource::start()
+	{
+		finished = false;
+		stopping = false;
+		inFlight = 0;
+		ready.clear();
+		current = Chunk();
+		currentOffset = 0;
+
+		reader = std::thread(&ReadAheadByteSource::run, this);
+	}
+
+	void ReadAheadByteSource::stop()
+	{
+		if (!reader.joinable())
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		slotFree.notify_all();
+		reader.join();
+
+		// keep the buffers around for the next start()
+		for (Chunk& chunk : ready)
+			spare.push_back(std::move(chunk));
+		ready.clear();
+	}
+
+	void ReadAheadByteSource::run()
+	{
+		while (true)
+		{
+			Chunk chunk;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				slotFree.wait(lock, [this] { return stopping || inFlight < depth; });
+				if (stopping)
+					return;
+
+				++inFlight;
+				if (!spare.empty()) {
+					chunk = std::move(spare.back());
+					spare.pop_back();
+				}
+			}
+
+			// the blocking read happens outside the lock
+			chunk.Data.resize(chunkSize);
+			chunk.Length = inner->read(chunk.Data.data(), chunkSize);
+			bool atEnd = chunk.Length < chunkSize;
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (chunk.Length > 0)
+					ready.push_back(std::move(chunk));
+				else
+					--inFlight;
+				finished = atEnd;
+			}
+			chunkReady.notify_one();
+
+			if (atEnd)
+				return;
+		}
+	}
+
+	size_t ReadAheadByteSource::fill(uint8_t* dst, size_t size)
+	{
+		size_t total = 0;
+
+		while (total < size)
+		{
+			if (currentOffset >= current.Length) {
+				std::unique_lock<std::mutex> lock(mutex);
+
+				if (current.Length > 0 || !current.Data.empty()) {
+					spare.push_back(std::move(current));
+					current = Chunk();
+					--inFlight;
+					slotFree.notify_one();
+				}
+
+				chunkReady.wait(lock, [this] { return !ready.empty() || finished; });
+				if (ready.empty())
+					break;
+
+				current = std::move(ready.front());
+				ready.pop_front();
+				currentOffset = 0;
+			}
+
+			size_t count = std::min(current.Length - currentOffset, size - total);
+			std::memcpy(dst + total, current.Data.data() + currentOffset, count);
+			currentOffset += count;
+			total += count;
+		}
+
+		return total;
+	}
+
+	bool ReadAheadByteSource::seekRaw(int64_t offset)
+	{
+		if (!inner->seekable())
+			return false;
+
+		stop();
+
+		if (current.Length > 0 || !current.Data.empty())
+			spare.push_back(std::move(current));
+
+		current = Chunk();
+		currentOffset = 0;
+
+		if (!inner->seek(offset, std::ios::beg)) {
+			finished = true;  // reader stays down, fill() reports the end
+			return false;
+		}
+
+		resetBuffer(offset);
+		start();
+		return true;
+	}
+
+}
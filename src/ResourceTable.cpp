@@ -0,0 +1,30 @@
+#include <demoanalyser/ResourceTable.h>
+
+namespace demo_analyser
+{
+	void ResourceTable::clear()
+	{
+		for (std::vector<ResourceEntry>& entries : byType)
+			entries.clear();
+		names.clear();
+		count = 0;
+	}
+
+	void ResourceTable::add(ResourceType type, uint32_t index, std::string_view name, uint32_t size, uint8_t flags)
+	{
+		if (static_cast<size_t>(type) >= ResourceTypeCount)
+			return;
+
+		std::vector<ResourceEntry>& entries = byType[static_cast<size_t>(type)];
+		if (index >= entries.size())
+			entries.resize(index + 1);
+
+		ResourceEntry& entry = entries[index];
+		if (entry.Name.empty())
+			++count;
+
+		entry.Name = *names.emplace(name).first;
+		entry.Size = size;
+		entry.Flags = flags;
+	}
+}
@@ -0,0 +1,279 @@
+#include <demoanalyser/SharedEventRing.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace demo_analyser
+{
+	namespace
+	{
+		constexpr uint32_t RingMagic = 0x474E5248;  // "HRNG"
+		constexpr uint32_t RingVersion = 2;
+	}
+
+	// Start of the shared memory object, followed by Capacity slots
+	struct alignas(64) SharedEventRingHeader
+	{
+		std::atomic<uint32_t> Magic;  // written last, once the rest is set up
+		uint32_t Version;
+		uint32_t SlotSize;
+		uint32_t Capacity;
+		uint32_t ProducerPid;         // process of the writer, to tell a live ring from a leftover
+
+		alignas(64) std::atomic<uint64_t> Published;  // records written so far
+		std::atomic<uint32_t> Closed;
+	};
+
+	// Sequence is 2n+1 while record n is being written into the slot and 2n+2 once it is complete
+	struct alignas(64) SharedEventSlot
+	{
+		std::atomic<uint64_t> Sequence;
+		SharedEventRecord Record;
+	};
+
+	// the ring is shared between processes, so the atomics must not fall back to locks
+	static_assert(std::atomic<uint64_t>::is_always_lock_free, "64-bit atomics must be lock-free");
+	static_assert(std::atomic<uint32_t>::is_always_lock_free, "32-bit atomics must be lock-free");
+
+	namespace
+	{
+		// True for a ring whose producer process is gone without removing it. Anything else
+		// under the name (a live ring, one being set up, another program's object) is kept.
+		bool isAbandonedRing(const std::string& name)
+		{
+			int fd = ::shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+			if (fd < 0)
+				return false;
+
+			struct stat st{};
+			if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SharedEventRingHeader)) {
+				::close(fd);
+				return false;
+			}
+
+			void* address = ::mmap(nullptr, sizeof(SharedEventRingHeader), PROT_READ, MAP_SHARED, fd, 0);
+			::close(fd);
+			if (address == MAP_FAILED)
+				return false;
+
+			const SharedEventRingHeader* ring = static_cast<const SharedEventRingHeader*>(address);
+			bool abandoned = ring->Magic.load(std::memory_order_acquire) == RingMagic && ring->ProducerPid != 0
+				&& ::kill(static_cast<pid_t>(ring->ProducerPid), 0) != 0 && errno == ESRCH;
+
+			::munmap(address, sizeof(SharedEventRingHeader));
+			return abandoned;
+		}
+	}
+
+	SharedEventRingWriter::SharedEventRingWriter(const std::string& name_, uint32_t capacity)
+		: name(name_)
+	{
+		uint32_t slotCount = 2;
+		while (slotCount < capacity && slotCount < (1u << 30))
+			slotCount <<= 1;
+
+		int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+
+		// left behind by a producer that did not shut down
+		if (fd < 0 && errno == EEXIST && isAbandonedRing(name)) {
+			::shm_unlink(name.c_str());
+			fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+		}
+
+		if (fd < 0) {
+			lastError = std::strerror(errno);
+			return;
+		}
+
+		size_t size = sizeof(SharedEventRingHeader) + static_cast<size_t>(slotCount) * sizeof(SharedEventSlot);
+		if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+			lastError = std::strerror(errno);
+			::close(fd);
+			::shm_unlink(name.c_str());
+			return;
+		}
+
+		void* address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (address == MAP_FAILED) {
+			lastError = std::strerror(errno);
+			::shm_unlink(name.c_str());
+			return;
+		}
+
+		// the object starts zero-filled: every sequence and counter is already 0
+		header = static_cast<SharedEventRingHeader*>(address);
+		slots = reinterpret_cast<SharedEventSlot*>(static_cast<uint8_t*>(address) + sizeof(SharedEventRingHeader));
+		mappingSize = size;
+		mask = slotCount - 1;
+
+		header->Version = RingVersion;
+		header->SlotSize = sizeof(SharedEventSlot);
+		header->Capacity = slotCount;
+		header->ProducerPid = static_cast<uint32_t>(::getpid());
+		header->Magic.store(RingMagic, std::memory_order_release);
+	}
+
+	SharedEventRingWriter::~SharedEventRingWriter()
+	{
+		if (!header)
+			return;
+
+		finish();
+		::munmap(header, mappingSize);
+		::shm_unlink(name.c_str());
+	}
+
+	void SharedEventRingWriter::finish()
+	{
+		if (header)
+			header->Closed.store(1, std::memory_order_release);
+	}
+
+	void SharedEventRingWriter::publish(DemoEventType type, float time, uint32_t frame, const void* data, size_t size, uint32_t textLength, bool truncated)
+	{
+		if (!header)
+			return;
+
+		SharedEventSlot& slot = slots[sequence & mask];
+
+		// readers of the record being replaced see the odd sequence and drop it
+		slot.Sequence.store(2 * sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		SharedEventRecord& record = slot.Record;
+		record.Type = type;
+		record.Truncated = truncated;
+		record.FrameNumber = frame;
+		record.Timestamp = time;
+		record.TextLength = textLength;
+		std::memcpy(record.Payload, data, size);
+
+		slot.Sequence.store(2 * sequence + 2, std::memory_order_release);
+		++sequence;
+		header->Published.store(sequence, std::memory_order_release);
+	}
+
+	template<typename T>
+	void SharedEventRingWriter::publish(DemoEventType type, float time, uint32_t frame, const T& value)
+	{
+		static_assert(sizeof(T) <= SharedEventRecord::PayloadSize, "payload does not fit a ring record");
+		static_assert(std::is_trivially_copyable<T>::value, "ring payloads are copied as bytes");
+		publish(type, time, frame, &value, sizeof(T), 0, false);
+	}
+
+	void SharedEventRingWriter::handle(DemoEventType type, float time, uint32_t frame, const std::string& text)
+	{
+		size_t length = std::min(text.size(), SharedEventRecord::PayloadSize);
+		publish(type, time, frame, text.data(), length, static_cast<uint32_t>(length), length < text.size());
+	}
+
+	void SharedEventRingWriter::handle(DemoEventType type, float time, uint32_t frame, const PlayerState& state) { publish(type, time, frame, state); }
+	void SharedEventRingWriter::handle(DemoEventType type, float time, uint32_t frame, const EventFrame& eventFrame) { publish(type, time, frame, eventFrame); }
+	void SharedEventRingWriter::handle(DemoEventType type, float time, uint32_t frame, float value) { publish(type, time, frame, value); }
+	void SharedEventRingWriter::handle(DemoEventType type, float time, uint32_t frame, const ClientData& clientData) { publish(type, time, frame, clientData); }
+	void SharedEventRingWriter::handle(DemoEventType type, float time, uint32_t frame, const Angle& angle) { publish(type, time, frame, angle); }
+	void SharedEventRingWriter::handle(DemoEventType type, float time, uint32_t frame, const EntityStatePlayer& entity) { publish(type, time, frame, entity); }
+	void SharedEventRingWriter::handle(DemoEventType type, float time, uint32_t frame, const CustomEntityState& entity) { publish(type, time, frame, entity); }
+
+	SharedEventRingReader::SharedEventRingReader(const std::string& name, bool fromNewest)
+	{
+		int fd = ::shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+		if (fd < 0) {
+			lastError = std::strerror(errno);
+			return;
+		}
+
+		struct stat st{};
+		if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SharedEventRingHeader)) {
+			lastError = "Not an event ring";
+			::close(fd);
+			return;
+		}
+
+		size_t size = static_cast<size_t>(st.st_size);
+		void* address = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (address == MAP_FAILED) {
+			lastError = std::strerror(errno);
+			return;
+		}
+
+		const SharedEventRingHeader* ring = static_cast<const SharedEventRingHeader*>(address);
+		bool valid = ring->Magic.load(std::memory_order_acquire) == RingMagic
+			&& ring->Version == RingVersion
+			&& ring->SlotSize == sizeof(SharedEventSlot)
+			&& ring->Capacity != 0 && (ring->Capacity & (ring->Capacity - 1)) == 0
+			&& size == sizeof(SharedEventRingHeader) + static_cast<size_t>(ring->Capacity) * sizeof(SharedEventSlot);
+
+		if (!valid) {
+			lastError = "Not an event ring, or written by an incompatible build";
+			::munmap(address, size);
+			return;
+		}
+
+		header = ring;
+		slots = reinterpret_cast<const SharedEventSlot*>(static_cast<const uint8_t*>(address) + sizeof(SharedEventRingHeader));
+		mappingSize = size;
+		mask = ring->Capacity - 1;
+
+		uint64_t published = ring->Published.load(std::memory_order_acquire);
+		if (fromNewest)
+			position = published;
+		else
+			position = published > ring->Capacity ? published - ring->Capacity : 0;
+	}
+
+	SharedEventRingReader::~SharedEventRingReader()
+	{
+		if (header)
+			::munmap(const_cast<SharedEventRingHeader*>(header), mappingSize);
+	}
+
+	SharedEventRingReader::ReadResult SharedEventRingReader::read(SharedEventRecord& record)
+	{
+		if (!header)
+			return ReadResult::Closed;
+
+		while (true)
+		{
+			// Closed first: once it is seen, Published already counts every record
+			bool closed = header->Closed.load(std::memory_order_acquire) != 0;
+			uint64_t published = header->Published.load(std::memory_order_acquire);
+			if (position >= published)
+				return closed ? ReadResult::Closed : ReadResult::Empty;
+
+			// lapped: the oldest records are gone
+			uint64_t capacity = mask + 1;
+			if (published - position > capacity) {
+				droppedRecords += published - capacity - position;
+				position = published - capacity;
+			}
+
+			const SharedEventSlot& slot = slots[position & mask];
+			uint64_t expected = 2 * position + 2;
+
+			if (slot.Sequence.load(std::memory_order_acquire) == expected) {
+				std::memcpy(&record, &slot.Record, sizeof(record));
+				std::atomic_thread_fence(std::memory_order_acquire);
+
+				if (slot.Sequence.load(std::memory_order_relaxed) == expected) {
+					++position;
+					return ReadResult::Event;
+				}
+			}
+
+			// the producer is already reusing the slot for a later record
+			++droppedRecords;
+			++position;
+		}
+	}
+}
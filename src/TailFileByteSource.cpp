@@ -0,0 +1,84 @@
+#include <demoanalyser/TailFileByteSource.h>
+
+#include <cerrno>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace demo_analyser
+{
+
+	TailFileByteSource::TailFileByteSource(const std::string& path,
+		std::chrono::milliseconds idleTimeout_, std::chrono::milliseconds pollInterval_)
+		: idleTimeout(idleTimeout_), pollInterval(pollInterval_)
+	{
+		fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			ok = false;
+			return;
+		}
+
+		// Wakes us as soon as the recorder writes; without it we fall back to polling
+		notifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (notifyFd >= 0 && ::inotify_add_watch(notifyFd, path.c_str(), IN_MODIFY | IN_CLOSE_WRITE) < 0) {
+			::close(notifyFd);
+			notifyFd = -1;
+		}
+	}
+
+	TailFileByteSource::~TailFileByteSource()
+	{
+		if (notifyFd >= 0)
+			::close(notifyFd);
+		if (fd >= 0)
+			::close(fd);
+	}
+
+	void TailFileByteSource::waitForData()
+	{
+		if (notifyFd < 0) {
+			std::this_thread::sleep_for(pollInterval);
+			return;
+		}
+
+		// the poll interval still bounds the wait, so stop() and network filesystems that
+		// never deliver events are noticed
+		pollfd descriptor{notifyFd, POLLIN, 0};
+		if (::poll(&descriptor, 1, static_cast<int>(pollInterval.count())) > 0) {
+			char events[4096];
+			while (::read(notifyFd, events, sizeof(events)) > 0) {}
+		}
+	}
+
+	size_t TailFileByteSource::fill(uint8_t* dst, size_t size)
+	{
+		if (fd < 0)
+			return 0;
+
+		auto idleSince = std::chrono::steady_clock::now();
+
+		while (!stopped)
+		{
+			ssize_t count = ::read(fd, dst, size);
+
+			if (count > 0)
+				return static_cast<size_t>(count);
+
+			if (count < 0 && errno != EINTR)
+				return 0;
+
+			if (count == 0) {
+				if (std::chrono::steady_clock::now() - idleSince >= idleTimeout)
+					return 0;
+
+				waitForData();
+			}
+		}
+
+		return 0;
+	}
+
+}
@@ -0,0 +1,317 @@
+#include <demoanalyser/TextExporter.h>
+
+#include <cmath>
+#include <cstring>
+
+namespace demo_analyser
+{
+	namespace
+	{
+		// Length of the well-formed UTF-8 sequence starting at text[i], 0 when the bytes there
+		// are not one (overlong forms, surrogates and values past U+10FFFF included)
+		size_t utf8SequenceLength(std::string_view text, size_t i)
+		{
+			auto byte = [&](size_t k) { return static_cast<unsigned char>(text[k]); };
+			auto continuation = [&](size_t k, unsigned char low, unsigned char high) {
+				return k < text.size() && byte(k) >= low && byte(k) <= high;
+			};
+
+			unsigned char lead = byte(i);
+			if (lead >= 0xc2 && lead <= 0xdf)
+				return continuation(i + 1, 0x80, 0xbf) ? 2 : 0;
+
+			if (lead >= 0xe0 && lead <= 0xef) {
+				unsigned char low = lead == 0xe0 ? 0xa0 : 0x80;
+				unsigned char high = lead == 0xed ? 0x9f : 0xbf;
+				return continuation(i + 1, low, high) && continuation(i + 2, 0x80, 0xbf) ? 3 : 0;
+			}
+
+			if (lead >= 0xf0 && lead <= 0xf4) {
+				unsigned char low = lead == 0xf0 ? 0x90 : 0x80;
+				unsigned char high = lead == 0xf4 ? 0x8f : 0xbf;
+				return continuation(i + 1, low, high) && continuation(i + 2, 0x80, 0xbf) &&
+					continuation(i + 3, 0x80, 0xbf) ? 4 : 0;
+			}
+
+			return 0;
+		}
+	}
+
+	TextExporter::Table::Table(const std::string& path, TextFormat format_, std::vector<const char*> columns_)
+		: out(path), format(format_), columns(std::move(columns_))
+	{
+		columns.insert(columns.begin(), {"frame", "time"});
+
+		if (format == TextFormat::Csv) {
+			for (size_t i = 0; i < columns.size(); ++i) {
+				if (i > 0)
+					out.put(',');
+				out.write(columns[i]);
+			}
+			out.put('\n');
+		}
+	}
+
+	void TextExporter::Table::separator()
+	{
+		if (format == TextFormat::NDJson) {
+			if (column > 0)
+				out.put(',');
+			out.put('"');
+			out.write(columns[column]);
+			out.write("\":", 2);
+		} else if (column > 0) {
+			out.put(',');
+		}
+
+		++column;
+	}
+
+	void TextExporter::Table::begin(uint32_t frame, float time)
+	{
+		column = 0;
+		if (format == TextFormat::NDJson)
+			out.put('{');
+
+		field(static_cast<int64_t>(frame));
+		field(time);
+	}
+
+	void TextExporter::Table::field(int64_t value)
+	{
+		separator();
+		out.number(value);
+	}
+
+	void TextExporter::Table::field(float value)
+	{
+		separator();
+
+		// JSON has no NaN or infinity
+		if (format == TextFormat::NDJson && !std::isfinite(value))
+			out.write("null", 4);
+		else
+			out.number(value);
+	}
+
+	void TextExporter::Table::field(std::string_view text)
+	{
+		separator();
+
+		if (format == TextFormat::NDJson)
+		{
+			static const char hex[] = "0123456789abcdef";
+
+			out.put('"');
+			for (size_t i = 0; i < text.size(); ++i)
+			{
+				char c = text[i];
+				unsigned char u = static_cast<unsigned char>(c);
+				if (c == '"' || c == '\\') {
+					out.put('\\');
+					out.put(c);
+				} else if (u < 0x20) {
+					char escaped[6] = {'\\', 'u', '0', '0', hex[u >> 4], hex[u & 15]};
+					out.write(escaped, sizeof(escaped));
+				} else if (u < 0x80) {
+					out.put(c);
+				} else if (size_t length = utf8SequenceLength(text, i)) {
+					out.write(text.substr(i, length));
+					i += length - 1;
+				} else {
+					// game strings are mostly Latin-1: a byte outside UTF-8 becomes that code point
+					char escaped[6] = {'\\', 'u', '0', '0', hex[u >> 4], hex[u & 15]};
+					out.write(escaped, sizeof(escaped));
+				}
+			}
+			out.put('"');
+		}
+		else
+		{
+			// quote only when needed, doubling embedded quotes
+			if (text.find_first_of(",\"\r\n") == std::string_view::npos) {
+				out.write(text);
+				return;
+			}
+
+			out.put('"');
+			for (char c : text) {
+				if (c == '"')
+					out.put('"');
+				out.put(c);
+			}
+			out.put('"');
+		}
+	}
+
+	void TextExporter::Table::end()
+	{
+		if (format == TextFormat::NDJson)
+			out.put('}');
+		out.put('\n');
+	}
+
+	TextExporter::TextExporter(const std::string& prefix, TextFormat format)
+	{
+		std::string extension = format == TextFormat::NDJson ? ".ndjson" : ".csv";
+		auto table = [&](const char* name, std::vector<const char*> columns) {
+			paths.push_back(prefix + name + extension);
+			return std::make_unique<Table>(paths.back(), format, std::move(columns));
+		};
+
+		prints = table("prints", {"text"});
+		consoleCommands = table("console_commands", {"command"});
+		playerStates = table("player_states", {"position_x", "position_y", "position_z",
+			"rotation_x", "rotation_y", "rotation_z", "weapon_flags", "fov"});
+		clientData = table("client_data", {"origin_x", "origin_y", "origin_z", "velocity_x", "velocity_y", "velocity_z",
+			"punchangle_x", "punchangle_y", "punchangle_z", "health", "maxspeed", "fov",
+			"flags", "weapons", "weapon_id", "weaponanim", "deadflag"});
+		entityUpdates = table("entity_updates", {"kind", "entity", "origin_x", "origin_y", "origin_z",
+			"angles_x", "angles_y", "angles_z", "modelindex", "sequence", "gaitsequence", "weaponmodel", "team"});
+		userInfo = table("user_info", {"client_index", "user_id", "info"});
+		serverInfo = table("server_info", {"protocol", "max_players", "player_index", "game_dir", "hostname", "map"});
+		eventFrames = table("event_frames", {"index", "flags", "delay", "entity",
+			"origin_x", "origin_y", "origin_z", "angles_x", "angles_y", "angles_z",
+			"fparam1", "fparam2", "iparam1", "iparam2", "bparam1", "bparam2"});
+	}
+
+	TextExporter::~TextExporter()
+	{
+		finish();
+	}
+
+	void TextExporter::finish()
+	{
+		for (Table* table : {prints.get(), consoleCommands.get(), playerStates.get(), clientData.get(),
+			entityUpdates.get(), userInfo.get(), serverInfo.get(), eventFrames.get()})
+			table->writer().close();
+	}
+
+	bool TextExporter::good() const
+	{
+		for (Table* table : {prints.get(), consoleCommands.get(), playerStates.get(), clientData.get(),
+			entityUpdates.get(), userInfo.get(), serverInfo.get(), eventFrames.get()})
+			if (!table->writer().good())
+				return false;
+		return true;
+	}
+
+	void TextExporter::handle(DemoEventType type, float time, uint32_t frame, const std::string& text)
+	{
+		Table* table = nullptr;
+		if (type == DemoEventType::MessagePrint)
+			table = prints.get();
+		else if (type == DemoEventType::ConsoleCommand)
+			table = consoleCommands.get();
+		else
+			return;
+
+		table->begin(frame, time);
+		table->field(std::string_view(text));
+		table->end();
+	}
+
+	void TextExporter::handle(DemoEventType, float time, uint32_t frame, const PlayerState& state)
+	{
+		Table& t = *playerStates;
+		t.begin(frame, time);
+		for (float value : state.position) t.field(value);
+		for (float value : state.rotation) t.field(value);
+		t.field(static_cast<int64_t>(state.weaponFlags));
+		t.field(state.fov);
+		t.end();
+	}
+
+	void TextExporter::handle(DemoEventType, float time, uint32_t frame, const ClientData& data)
+	{
+		Table& t = *clientData;
+		t.begin(frame, time);
+		for (float value : data.origin) t.field(value);
+		for (float value : data.velocity) t.field(value);
+		for (float value : data.punchangle) t.field(value);
+		t.field(data.health);
+		t.field(data.maxspeed);
+		t.field(data.fov);
+		t.field(static_cast<int64_t>(data.flags));
+		t.field(static_cast<int64_t>(data.weapons));
+		t.field(static_cast<int64_t>(data.m_iId));
+		t.field(static_cast<int64_t>(data.weaponanim));
+		t.field(static_cast<int64_t>(data.deadflag));
+		t.end();
+	}
+
+	void TextExporter::handle(DemoEventType, float time, uint32_t frame, const UpdateUserInfo& info)
+	{
+		Table& t = *userInfo;
+		t.begin(frame, time);
+		t.field(static_cast<int64_t>(info.ClientIndex));
+		t.field(static_cast<int64_t>(info.ClientUserID));
+		t.field(std::string_view(info.ClientUserInfo));
+		t.end();
+	}
+
+	void TextExporter::handle(DemoEventType, float time, uint32_t frame, const ServerInfo& info)
+	{
+		Table& t = *serverInfo;
+		t.begin(frame, time);
+		t.field(static_cast<int64_t>(info.Protocol));
+		t.field(static_cast<int64_t>(info.MaxPlayers));
+		t.field(static_cast<int64_t>(info.PlayerIndex));
+		t.field(std::string_view(info.GameDir));
+		t.field(std::string_view(info.Hostname));
+		t.field(std::string_view(info.MapFileName));
+		t.end();
+	}
+
+	void TextExporter::handle(DemoEventType, float time, uint32_t frame, const EventFrame& event)
+	{
+		Table& t = *eventFrames;
+		t.begin(frame, time);
+		t.field(static_cast<int64_t>(event.index));
+		t.field(static_cast<int64_t>(event.flags));
+		t.field(event.delay);
+		t.field(static_cast<int64_t>(event.args.entityIndex));
+		for (float value : event.args.origin) t.field(value);
+		for (float value : event.args.angles) t.field(value);
+		t.field(event.args.fparam1);
+		t.field(event.args.fparam2);
+		t.field(static_cast<int64_t>(event.args.iparam1));
+		t.field(static_cast<int64_t>(event.args.iparam2));
+		t.field(static_cast<int64_t>(event.args.bparam1));
+		t.field(static_cast<int64_t>(event.args.bparam2));
+		t.end();
+	}
+
+	void TextExporter::handle(DemoEventType type, float time, uint32_t frame, const EntityStatePlayer& entity)
+	{
+		Table& t = *entityUpdates;
+		t.begin(frame, time);
+		t.field(std::string_view(type == DemoEventType::PackedPlayerEntity ? "packed_player" : "delta_player"));
+		t.field(static_cast<int64_t>(entity.entityNumber));
+		for (float value : entity.origin) t.field(value);
+		for (float value : entity.angles) t.field(value);
+		t.field(static_cast<int64_t>(entity.modelindex));
+		t.field(static_cast<int64_t>(entity.sequence));
+		t.field(static_cast<int64_t>(entity.gaitsequence));
+		t.field(static_cast<int64_t>(entity.weaponmodel));
+		t.field(static_cast<int64_t>(entity.team));
+		t.end();
+	}
+
+	void TextExporter::handle(DemoEventType type, float time, uint32_t frame, const CustomEntityState& entity)
+	{
+		Table& t = *entityUpdates;
+		t.begin(frame, time);
+		t.field(std::string_view(type == DemoEventType::PackedCustomEntity ? "packed_custom" : "delta_custom"));
+		t.field(static_cast<int64_t>(entity.entityNumber));
+		for (float value : entity.origin) t.field(value);
+		for (float value : entity.angles) t.field(value);
+		t.field(static_cast<int64_t>(entity.modelindex));
+		t.field(static_cast<int64_t>(entity.sequence));
+		t.field(static_cast<int64_t>(0));  // player-only columns
+		t.field(static_cast<int64_t>(0));
+		t.field(static_cast<int64_t>(0));
+		t.end();
+	}
+
+}
@@ -0,0 +1,328 @@
+#include <demoanalyser/TrajectoryWriter.h>
+
+#include <demoanalyser/ByteSource.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace demo_analyser
+{
+	namespace
+	{
+		// .hltj layout:
+		//   "HLTJ" <version byte>
+		//   blocks: <varint entity> <varint count> 7 x (<varint length << 2 | mode> <column bytes>)
+		// mode bit 0: deltas of deltas instead of deltas, bit 1: bit-packed instead of varints
+		const char Magic[4] = {'H', 'L', 'T', 'J'};
+		constexpr uint8_t Version = 1;
+
+		constexpr size_t TimeColumn = 0;
+		constexpr size_t FirstAngleColumn = 4;
+		constexpr size_t ColumnCount = 7;
+
+		constexpr uint64_t SecondOrderMode = 1;
+		constexpr uint64_t BitPackedMode = 2;
+
+		constexpr double OriginScale = 8.0;             // entity_state_player_t origin divisor
+		constexpr double AngleScale = 65536.0 / 360.0;  // 16-bit DT_ANGLE
+
+		uint64_t zigzag(int64_t value) { return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63); }
+		int64_t unzigzag(uint64_t value) { return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1); }
+
+		// angle steps wrap around the circle, so their deltas are taken modulo 2^16
+		int64_t wrap(int64_t value, bool angle) { return angle ? static_cast<int16_t>(value) : value; }
+
+		void putVarint(std::vector<uint8_t>& bytes, uint64_t value)
+		{
+			while (value >= 0x80) {
+				bytes.push_back(static_cast<uint8_t>(value | 0x80));
+				value >>= 7;
+			}
+			bytes.push_back(static_cast<uint8_t>(value));
+		}
+
+		bool getVarint(const uint8_t*& cursor, const uint8_t* end, uint64_t& value)
+		{
+			value = 0;
+			for (int shift = 0; shift < 64; shift += 7) {
+				if (cursor == end)
+					return false;
+				uint8_t byte = *cursor++;
+				value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+				if (!(byte & 0x80))
+					return true;
+			}
+			return false;
+		}
+
+		// Column residuals, zigzagged: the first value as is, then deltas (or deltas of deltas)
+		void encodeResiduals(const std::vector<int64_t>& values, bool angle, bool secondOrder, std::vector<uint64_t>& residuals)
+		{
+			residuals.clear();
+			int64_t previousDelta = 0;
+			for (size_t i = 0; i < values.size(); ++i) {
+				if (i == 0) {
+					residuals.push_back(zigzag(values[0]));
+					continue;
+				}
+
+				int64_t delta = wrap(values[i] - values[i - 1], angle);
+				residuals.push_back(zigzag(secondOrder && i > 1 ? wrap(delta - previousDelta, angle) : delta));
+				previousDelta = delta;
+			}
+		}
+
+		void decodeResiduals(const std::vector<uint64_t>& residuals, bool angle, bool secondOrder, std::vector<int64_t>& values)
+		{
+			values.resize(residuals.size());
+			int64_t previousDelta = 0;
+			for (size_t i = 0; i < residuals.size(); ++i) {
+				if (i == 0) {
+					values[0] = unzigzag(residuals[0]);
+					continue;
+				}
+
+				int64_t delta = unzigzag(residuals[i]);
+				if (secondOrder && i > 1)
+					delta = wrap(previousDelta + delta, angle);
+
+				values[i] = values[i - 1] + delta;
+				if (angle)
+					values[i] &= 0xFFFF;
+				previousDelta = delta;
+			}
+		}
+
+		void packVarints(const std::vector<uint64_t>& residuals, std::vector<uint8_t>& bytes)
+		{
+			for (uint64_t residual : residuals)
+				putVarint(bytes, residual);
+		}
+
+		// The first residual as a varint, then a width byte and the rest at that many bits each,
+		// low bits first. Smooth motion leaves only a few bits per sample, a still column none.
+		void packBits(const std::vector<uint64_t>& residuals, std::vector<uint8_t>& bytes)
+		{
+			putVarint(bytes, residuals[0]);
+
+			uint64_t widest = 0;
+			for (size_t i = 1; i < residuals.size(); ++i)
+				widest |= residuals[i];
+
+			uint32_t width = widest ? 64 - static_cast<uint32_t>(__builtin_clzll(widest)) : 0;
+			bytes.push_back(static_cast<uint8_t>(width));
+
+			uint64_t pending = 0;
+			uint32_t pendingBits = 0;
+			for (size_t i = 1; i < residuals.size(); ++i) {
+				for (uint32_t bit = 0; bit < width; ++bit) {
+					pending |= ((residuals[i] >> bit) & 1) << pendingBits;
+					if (++pendingBits == 8) {
+						bytes.push_back(static_cast<uint8_t>(pending));
+						pending = 0;
+						pendingBits = 0;
+					}
+				}
+			}
+			if (pendingBits)
+				bytes.push_back(static_cast<uint8_t>(pending));
+		}
+
+		bool unpackVarints(const uint8_t* cursor, const uint8_t* end, size_t count, std::vector<uint64_t>& residuals)
+		{
+			residuals.resize(count);
+			for (uint64_t& residual : residuals)
+				if (!getVarint(cursor, end, residual))
+					return false;
+			return cursor == end;
+		}
+
+		bool unpackBits(const uint8_t* cursor, const uint8_t* end, size_t count, std::vector<uint64_t>& residuals)
+		{
+			residuals.assign(count, 0);
+			if (count == 0)
+				return cursor == end;
+
+			if (!getVarint(cursor, end, residuals[0]) || cursor == end)
+				return false;
+
+			uint32_t width = *cursor++;
+			if (width > 64 || static_cast<uint64_t>(end - cursor) != ((count - 1) * width + 7) / 8)
+				return false;
+
+			uint64_t bitPosition = 0;
+			for (size_t i = 1; i < count; ++i)
+				for (uint32_t bit = 0; bit < width; ++bit, ++bitPosition)
+					residuals[i] |= static_cast<uint64_t>((cursor[bitPosition >> 3] >> (bitPosition & 7)) & 1) << bit;
+			return true;
+		}
+	}
+
+	TrajectoryWriter::TrajectoryWriter(const std::string& path)
+		: out(path)
+	{
+		out.write(Magic, sizeof(Magic));
+		out.put(static_cast<char>(Version));
+	}
+
+	TrajectoryWriter::~TrajectoryWriter()
+	{
+		finish();
+	}
+
+	void TrajectoryWriter::finish()
+	{
+		if (finished)
+			return;
+		finished = true;
+
+		for (auto& entry : tracks)
+			if (entry.second.Count > 0)
+				writeBlock(entry.first, entry.second);
+
+		out.close();
+	}
+
+	void TrajectoryWriter::handle(DemoEventType, float time, uint32_t, const PlayerState& state)
+	{
+		add(0, time, state.position, state.rotation);
+	}
+
+	void TrajectoryWriter::handle(DemoEventType, float time, uint32_t, const EntityStatePlayer& entity)
+	{
+		add(entity.entityNumber, time, entity.origin, entity.angles);
+	}
+
+	void TrajectoryWriter::add(uint32_t entity, float time, const float origin[3], const float angles[3])
+	{
+		Track& track = tracks[entity];
+
+		track.Columns[TimeColumn].push_back(std::llround(static_cast<double>(time) * 1000.0));
+		for (size_t axis = 0; axis < 3; ++axis) {
+			track.Columns[1 + axis].push_back(std::llround(origin[axis] * OriginScale));
+			track.Columns[FirstAngleColumn + axis].push_back(std::llround(angles[axis] * AngleScale) & 0xFFFF);
+		}
+
+		++samples;
+		if (++track.Count == BlockSamples)
+			writeBlock(entity, track);
+	}
+
+	void TrajectoryWriter::writeBlock(uint32_t entity, Track& track)
+	{
+		scratch.clear();
+		putVarint(scratch, entity);
+		putVarint(scratch, track.Count);
+
+		std::vector<uint64_t> firstOrder, secondOrder;
+		std::vector<uint8_t> candidate, best;
+		for (size_t column = 0; column < ColumnCount; ++column) {
+			bool angle = column >= FirstAngleColumn;
+
+			encodeResiduals(track.Columns[column], angle, false, firstOrder);
+			encodeResiduals(track.Columns[column], angle, true, secondOrder);
+
+			// keep whichever of the four encodings is smallest for this block
+			uint64_t bestMode = 0;
+			best.clear();
+			for (uint64_t mode = 0; mode < 4; ++mode) {
+				const std::vector<uint64_t>& residuals = mode & SecondOrderMode ? secondOrder : firstOrder;
+
+				candidate.clear();
+				if (mode & BitPackedMode)
+					packBits(residuals, candidate);
+				else
+					packVarints(residuals, candidate);
+
+				if (mode == 0 || candidate.size() < best.size()) {
+					best.swap(candidate);
+					bestMode = mode;
+				}
+			}
+
+			putVarint(scratch, (static_cast<uint64_t>(best.size()) << 2) | bestMode);
+			scratch.insert(scratch.end(), best.begin(), best.end());
+
+			track.Columns[column].clear();
+		}
+
+		track.Count = 0;
+		out.write(reinterpret_cast<const char*>(scratch.data()), scratch.size());
+	}
+
+	bool DecodeTrajectories(const uint8_t* data, size_t size, std::vector<Trajectory>& trajectories)
+	{
+		trajectories.clear();
+
+		if (size < sizeof(Magic) + 1 || std::memcmp(data, Magic, sizeof(Magic)) != 0 || data[sizeof(Magic)] != Version)
+			return false;
+
+		const uint8_t* cursor = data + sizeof(Magic) + 1;
+		const uint8_t* end = data + size;
+
+		std::map<uint32_t, size_t> trackIndex;
+		std::vector<uint64_t> residuals;
+		std::vector<int64_t> values;
+
+		while (cursor != end)
+		{
+			uint64_t entity = 0, count = 0;
+			if (!getVarint(cursor, end, entity) || !getVarint(cursor, end, count) || entity > UINT32_MAX || count > TrajectoryWriter::BlockSamples)
+				return false;
+
+			auto found = trackIndex.find(static_cast<uint32_t>(entity));
+			if (found == trackIndex.end()) {
+				found = trackIndex.emplace(static_cast<uint32_t>(entity), trajectories.size()).first;
+				trajectories.emplace_back();
+				trajectories.back().Entity = static_cast<uint32_t>(entity);
+			}
+			Trajectory& trajectory = trajectories[found->second];
+
+			std::vector<float>* columns[ColumnCount] = {
+				&trajectory.Time, &trajectory.X, &trajectory.Y, &trajectory.Z,
+				&trajectory.Pitch, &trajectory.Yaw, &trajectory.Roll,
+			};
+
+			for (size_t column = 0; column < ColumnCount; ++column)
+			{
+				uint64_t header = 0;
+				if (!getVarint(cursor, end, header))
+					return false;
+
+				uint64_t length = header >> 2;
+				uint64_t mode = header & 3;
+				if (length > static_cast<uint64_t>(end - cursor))
+					return false;
+
+				bool unpacked = mode & BitPackedMode
+					? unpackBits(cursor, cursor + length, static_cast<size_t>(count), residuals)
+					: unpackVarints(cursor, cursor + length, static_cast<size_t>(count), residuals);
+				if (!unpacked)
+					return false;
+				cursor += length;
+
+				bool angle = column >= FirstAngleColumn;
+				decodeResiduals(residuals, angle, mode & SecondOrderMode, values);
+
+				double scale = column == TimeColumn ? 1000.0 : angle ? AngleScale : OriginScale;
+				std::vector<float>& target = *columns[column];
+				for (int64_t value : values)
+					target.push_back(static_cast<float>(value / scale));
+			}
+		}
+
+		std::sort(trajectories.begin(), trajectories.end(),
+			[](const Trajectory& a, const Trajectory& b) { return a.Entity < b.Entity; });
+		return true;
+	}
+
+	bool ReadTrajectories(const std::string& path, std::vector<Trajectory>& trajectories)
+	{
+		MappedFileByteSource file(path);
+		if (!file.isOpen())
+			return false;
+
+		return DecodeTrajectories(file.data(), static_cast<size_t>(file.size()), trajectories);
+	}
+}